@@ -124,6 +124,8 @@ struct Person {
 };
 
 SNZ_SLICE(Person);
+SNZ_HASH_SET_NAMED(Person*, PersonPtrSet);
+SNZ_DYNARR_NAMED(Person*, PersonPtrDynArr);
 
 typedef struct {
     Person* a;
@@ -139,13 +141,20 @@ struct Room {
     Room* next;
 };
 
+SNZ_SLICE_NAMED(Room*, RoomPtrSlice);
+
 #define ROOM_MAX_PERSON_COUNT 4
 
 const char* main_loadedPath = NULL;
 PersonSlice main_people = { 0 };
 Room* main_firstRoom = NULL;
+RoomPtrSlice main_rooms = { 0 }; // same order as the list starting at main_firstRoom, for indexing rows
+float main_peopleNameColWidth = 0; // widest name in main_people, so the people list doesn't have to measure every name each frame
+uint64_t main_rosterGeneration = 0; // bumped whenever main_people is cleared or reimported, a reimport can land at the same address
+uint64_t main_peopleHoverGeneration = 0; // bumped on frames where any persons hoverAnim moved
 snz_Arena main_fileArenaA = { 0 };
 snz_Arena main_fileArenaB = { 0 };
+snz_ArenaMark main_roomsMark = { 0 }; // end of the file data in arena A, rooms get pushed after this and released on regroup
 
 snzu_Instance main_inst = { 0 };
 snzr_Font main_font = { 0 };
@@ -155,6 +164,15 @@ snzr_Texture main_xButton = { 0 };
 Person* main_draggedPerson = NULL;
 HMM_Vec2 main_draggedPersonMouseOffset = { 0 };
 
+#ifdef SNZ_ARENA_INSTRUMENT
+bool main_showArenaStats = false; // toggled with F3
+#endif
+
+#ifdef SNZ_PROFILE
+bool main_showProfile = false; // toggled with F4, F5 dumps the history to PROFILE_CSV_PATH
+#define PROFILE_CSV_PATH "profile.csv"
+#endif
+
 const char* _main_messageBoxMessageSignal = NULL;
 bool _main_messageBoxShouldBeError = false;
 
@@ -174,16 +192,6 @@ void main_startMessageBox(const char* msg, bool isError) {
 #define TEXT_PADDING 7
 #define BORDER_THICKNESS 1
 
-void main_pushToArenaIfNotInCollection(void** collection, int64_t collectionCount, void* new, snz_Arena* arena) {
-    for (int64_t i = 0; i < collectionCount; i++) {
-        void* ptr = collection[i];
-        if (ptr == new) {
-            return;
-        }
-    }
-    *SNZ_ARENA_PUSH(arena, void*) = new;
-}
-
 bool main_personInPersonSlice(Person* p, PersonPtrSlice slice) {
     for (int i = 0; i < slice.count; i++) {
         if (slice.elems[i] == p) {
@@ -193,8 +201,8 @@ bool main_personInPersonSlice(Person* p, PersonPtrSlice slice) {
     return false;
 }
 
-void main_buildPerson(Person* p, bool draggable, HMM_Vec4 textColor, snz_Arena* scratch) {
-    snzu_boxNew(snz_arenaFormatStr(scratch, "%p WOWZER", p));
+void main_buildPerson(Person* p, bool draggable, HMM_Vec4 textColor) {
+    snzu_boxNewPtr(p);
     snzu_boxSetDisplayStrLen(&main_font, textColor, p->name.elems, p->name.count);
     snzu_boxSetSizeFitText(TEXT_PADDING);
 
@@ -230,150 +238,162 @@ void main_buildPerson(Person* p, bool draggable, HMM_Vec4 textColor, snz_Arena*
 void main_clear() {
     snz_arenaClear(&main_fileArenaA);
     snz_arenaClear(&main_fileArenaB);
+    main_roomsMark = snz_arenaMark(&main_fileArenaA);
     main_people = (PersonSlice){ 0 };
     main_firstRoom = NULL;
+    main_rooms = (RoomPtrSlice){ 0 };
+    main_peopleNameColWidth = 0;
     main_loadedPath = NULL;
+    main_rosterGeneration++;
 }
 
-// FIXME: this leaks memory, explicitly store room data in one of the file arenas so it gets cleaned up
+// rooms are stored in file arena A after main_roomsMark, so each regroup releases the last one's rooms
+// all scratch usage is released before returning
 void main_autogroup(snz_Arena* scratch) {
-    // strong pairs
-    SNZ_ARENA_ARR_BEGIN(scratch, PersonPair);
-    for (int i = 0; i < main_people.count; i++) {
-        Person* p = &main_people.elems[i];
-        for (int j = i; j < main_people.count; j++) {
-            Person* other = &main_people.elems[j];
+    snz_arenaRestore(main_roomsMark);
+    main_firstRoom = NULL;
+    main_rooms = (RoomPtrSlice){ 0 };
 
-            bool found = false;
-            for (int k = 0; k < p->wantsFromFile.count; k++) {
-                if (p->validWants.elems[k] == other) {
-                    found = true;
-                    break;
+    snz_arenaTempScope(scratch) {
+        // strong pairs
+        SNZ_ARENA_ARR_BEGIN(scratch, PersonPair);
+        for (int i = 0; i < main_people.count; i++) {
+            Person* p = &main_people.elems[i];
+            for (int j = i; j < main_people.count; j++) {
+                Person* other = &main_people.elems[j];
+
+                bool found = false;
+                for (int k = 0; k < p->validWants.count; k++) {
+                    if (p->validWants.elems[k] == other) {
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) {
+                    continue;
                 }
-            }
-            if (!found) {
-                continue;
-            }
 
-            found = false;
-            for (int k = 0; k < other->wantsFromFile.count; k++) {
-                if (other->validWants.elems[k] == p) {
-                    found = true;
-                    break;
+                found = false;
+                for (int k = 0; k < other->validWants.count; k++) {
+                    if (other->validWants.elems[k] == p) {
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) {
+                    continue;
                 }
-            }
-            if (!found) {
-                continue;
-            }
 
-            *SNZ_ARENA_PUSH(scratch, PersonPair) = (PersonPair){
-                .a = p,
-                .b = other,
-            };
+                *SNZ_ARENA_PUSH(scratch, PersonPair) = (PersonPair){
+                    .a = p,
+                    .b = other,
+                };
+            }
         }
-    }
-    PersonPairSlice strongPairs = SNZ_ARENA_ARR_END(scratch, PersonPair);
-    main_firstRoom = NULL;
+        PersonPairSlice strongPairs = SNZ_ARENA_ARR_END(scratch, PersonPair);
 
-    // actual room gen
-    PersonPtrSlice peopleRemaining = {
-        .count = main_people.count,
-        .elems = SNZ_ARENA_PUSH_ARR(scratch, main_people.count, Person*),
-    };
-    for (int i = 0; i < peopleRemaining.count; i++) {
-        peopleRemaining.elems[i] = &main_people.elems[i];
-    }
-
-    while (true) { // FIXME: cutoff?
-        Room* room = SNZ_ARENA_PUSH(&main_fileArenaA, Room);
-        room->people = (PersonPtrSlice){
-            .count = 0,
-            .elems = SNZ_ARENA_PUSH_ARR(&main_fileArenaA, ROOM_MAX_PERSON_COUNT, Person*),
+        // actual room gen
+        // indices match main_people, and get nulled as people are placed. Set is for fast membership checks
+        PersonPtrSlice peopleRemaining = {
+            .count = main_people.count,
+            .elems = SNZ_ARENA_PUSH_ARR(scratch, main_people.count, Person*),
         };
-
-        PersonPair* minBasePair = NULL;
-        int minBasePairScore = 0;
-        for (int i = 0; i < strongPairs.count; i++) {
-            PersonPair* p = &strongPairs.elems[i];
-            if (main_personInPersonSlice(p->a, peopleRemaining) && main_personInPersonSlice(p->b, peopleRemaining)) {
-                int score = p->a->wantsCount + p->b->wantsCount;
-                if (!minBasePair || score < minBasePairScore) {
-                    minBasePair = p;
-                    minBasePairScore = score;
-                }
-            }
+        PersonPtrSet remainingSet = SNZ_HASH_SET_INIT(PersonPtrSet, scratch, main_people.count);
+        for (int i = 0; i < peopleRemaining.count; i++) {
+            peopleRemaining.elems[i] = &main_people.elems[i];
+            SNZ_HASH_SET_INSERT(PersonPtrSet, &remainingSet, &main_people.elems[i]);
         }
 
-        if (minBasePair) {
-            room->people.elems[0] = minBasePair->a;
-            room->people.elems[1] = minBasePair->b;
-            room->people.count += 2;
-        } else {
-            Person* found = NULL;
-            for (int i = 0; i < peopleRemaining.count; i++) {
-                Person* p = peopleRemaining.elems[i];
-                if (!p) {
-                    continue;
+        while (true) { // FIXME: cutoff?
+            Room* room = SNZ_ARENA_PUSH(&main_fileArenaA, Room);
+            room->people = (PersonPtrSlice){
+                .count = 0,
+                .elems = SNZ_ARENA_PUSH_ARR(&main_fileArenaA, ROOM_MAX_PERSON_COUNT, Person*),
+            };
+
+            PersonPair* minBasePair = NULL;
+            int minBasePairScore = 0;
+            for (int i = 0; i < strongPairs.count; i++) {
+                PersonPair* p = &strongPairs.elems[i];
+                if (PersonPtrSet_contains(&remainingSet, p->a) && PersonPtrSet_contains(&remainingSet, p->b)) {
+                    int score = p->a->wantsCount + p->b->wantsCount;
+                    if (!minBasePair || score < minBasePairScore) {
+                        minBasePair = p;
+                        minBasePairScore = score;
+                    }
                 }
-                found = p;
-                break;
-            }
-            if (!found) {
-                break;
             }
-            room->people.elems[0] = found;
-            room->people.count++;
-        }
 
-        // only append the room if we know it has ppl in it
-        room->next = main_firstRoom;
-        main_firstRoom = room;
-
-        while (room->people.count < ROOM_MAX_PERSON_COUNT) {
-            SNZ_ARENA_ARR_BEGIN(scratch, Person*);
-            for (int i = 0; i < room->people.count; i++) {
-                Person* p = room->people.elems[i];
-                for (int j = 0; j < p->adjacents.count; j++) {
-                    Person* adj = p->adjacents.elems[j];
-                    if (!main_personInPersonSlice(adj, peopleRemaining)) {
-                        continue;
-                    } else if (main_personInPersonSlice(adj, room->people)) {
+            if (minBasePair) {
+                room->people.elems[0] = minBasePair->a;
+                room->people.elems[1] = minBasePair->b;
+                room->people.count += 2;
+            } else {
+                Person* found = NULL;
+                for (int i = 0; i < peopleRemaining.count; i++) {
+                    Person* p = peopleRemaining.elems[i];
+                    if (!p) {
                         continue;
                     }
-                    *SNZ_ARENA_PUSH(scratch, Person*) = adj;
+                    found = p;
+                    break;
                 }
-            }
-            PersonPtrSlice adjacent = SNZ_ARENA_ARR_END_NAMED(scratch, Person*, PersonPtrSlice);
-            if (adjacent.count == 0) {
-                break;
-            }
-            Person* minAdjacent = NULL;
-            for (int i = 0; i < adjacent.count; i++) {
-                Person* adj = adjacent.elems[i];
-                if (!minAdjacent || adj->wantsCount < minAdjacent->wantsCount) {
-                    minAdjacent = adj;
+                if (!found) {
+                    break;
                 }
+                room->people.elems[0] = found;
+                room->people.count++;
             }
-            SNZ_ASSERT(minAdjacent, "null adjacent how");
 
-            room->people.elems[room->people.count] = minAdjacent;
-            room->people.count++;
-        }
-
-        for (int i = 0; i < room->people.count; i++) {
-            Person* p = room->people.elems[i];
-            bool found = false;
-            for (int k = 0; k < peopleRemaining.count; k++) {
-                Person* other = peopleRemaining.elems[k];
-                if (other == p) {
-                    peopleRemaining.elems[k] = NULL;
-                    found = true;
+            // only append the room if we know it has ppl in it
+            room->next = main_firstRoom;
+            main_firstRoom = room;
+
+            while (room->people.count < ROOM_MAX_PERSON_COUNT) {
+                SNZ_ARENA_ARR_BEGIN(scratch, Person*);
+                for (int i = 0; i < room->people.count; i++) {
+                    Person* p = room->people.elems[i];
+                    for (int j = 0; j < p->adjacents.count; j++) {
+                        Person* adj = p->adjacents.elems[j];
+                        if (!PersonPtrSet_contains(&remainingSet, adj)) {
+                            continue;
+                        } else if (main_personInPersonSlice(adj, room->people)) {
+                            continue;
+                        }
+                        *SNZ_ARENA_PUSH(scratch, Person*) = adj;
+                    }
+                }
+                PersonPtrSlice adjacent = SNZ_ARENA_ARR_END_NAMED(scratch, Person*, PersonPtrSlice);
+                if (adjacent.count == 0) {
                     break;
                 }
+                Person* minAdjacent = NULL;
+                for (int i = 0; i < adjacent.count; i++) {
+                    Person* adj = adjacent.elems[i];
+                    if (!minAdjacent || adj->wantsCount < minAdjacent->wantsCount) {
+                        minAdjacent = adj;
+                    }
+                }
+                SNZ_ASSERT(minAdjacent, "null adjacent how");
+
+                room->people.elems[room->people.count] = minAdjacent;
+                room->people.count++;
             }
-            SNZ_ASSERT(found, "couldn't remove person from remaining bc they weren't there.");
-        } // end removing ppl from remaining arr
+
+            for (int i = 0; i < room->people.count; i++) {
+                Person* p = room->people.elems[i];
+                bool found = PersonPtrSet_remove(&remainingSet, p);
+                SNZ_ASSERT(found, "couldn't remove person from remaining bc they weren't there.");
+                peopleRemaining.elems[p - main_people.elems] = NULL;
+            } // end removing ppl from remaining arr
+        }
+    } // end scratch scope
+
+    SNZ_ARENA_ARR_BEGIN(&main_fileArenaA, Room*);
+    for (Room* room = main_firstRoom; room; room = room->next) {
+        *SNZ_ARENA_PUSH(&main_fileArenaA, Room*) = room;
     }
+    main_rooms = SNZ_ARENA_ARR_END_NAMED(&main_fileArenaA, Room*, RoomPtrSlice);
 } // end autogroup
 
 // return indicates success, 1 good, 0 bad
@@ -433,6 +453,13 @@ void main_import(snz_Arena* scratch) {
     }
 
     main_loadedPath = path;
+    main_rosterGeneration++;
+
+    for (int i = 0; i < main_people.count; i++) {
+        Person* p = &main_people.elems[i];
+        HMM_Vec2 s = snzr_strSize(&main_font, p->name.elems, p->name.count, main_font.renderedSize);
+        main_peopleNameColWidth = SNZ_MAX(s.X, main_peopleNameColWidth);
+    }
 
     { // coloring by gender
         const char* genderStrs[2] = { "Male", "Female" };
@@ -463,19 +490,21 @@ void main_import(snz_Arena* scratch) {
                 names.count -= 2;
                 names.elems++;
             }
-            CharSliceSlice wantedNames = main_strSplit(names, ',', scratch);
-            for (int i = 0; i < wantedNames.count; i++) {
-                main_charSliceTrim(&wantedNames.elems[i]);
-            }
+            snz_arenaTempScope(scratch) { // split names only needed until they're copied into the wants
+                CharSliceSlice wantedNames = main_strSplit(names, ',', scratch);
+                for (int i = 0; i < wantedNames.count; i++) {
+                    main_charSliceTrim(&wantedNames.elems[i]);
+                }
 
-            SNZ_ARENA_ARR_BEGIN(&main_fileArenaA, PersonWant);
-            for (int i = 0; i < wantedNames.count; i++) {
-                *SNZ_ARENA_PUSH(&main_fileArenaA, PersonWant) = (PersonWant){
-                    .name = wantedNames.elems[i],
-                    .person = NULL,
-                };
+                SNZ_ARENA_ARR_BEGIN(&main_fileArenaA, PersonWant);
+                for (int i = 0; i < wantedNames.count; i++) {
+                    *SNZ_ARENA_PUSH(&main_fileArenaA, PersonWant) = (PersonWant){
+                        .name = wantedNames.elems[i],
+                        .person = NULL,
+                    };
+                }
+                p->wantsFromFile = SNZ_ARENA_ARR_END(&main_fileArenaA, PersonWant);
             }
-            p->wantsFromFile = SNZ_ARENA_ARR_END(&main_fileArenaA, PersonWant);
 
             for (int otherIdx = 0; otherIdx < main_people.count; otherIdx++) {
                 Person* other = &main_people.elems[otherIdx];
@@ -512,38 +541,50 @@ void main_import(snz_Arena* scratch) {
     }
 
     // adjacents
-    for (int i = 0; i < main_people.count; i++) {
-        Person* p = &main_people.elems[i];
+    snz_arenaTempScope(scratch) {
+        // everyone who wants each person, in file order, indices match main_people
+        PersonPtrDynArr* wantedBy = SNZ_ARENA_PUSH_ARR(scratch, main_people.count, PersonPtrDynArr);
+        for (int i = 0; i < main_people.count; i++) {
+            wantedBy[i] = SNZ_DYNARR_INIT(PersonPtrDynArr, scratch, 0);
+        }
+        for (int i = 0; i < main_people.count; i++) {
+            Person* p = &main_people.elems[i];
+            for (int j = 0; j < p->validWants.count; j++) {
+                *SNZ_DYNARR_PUSH(PersonPtrDynArr, &wantedBy[p->validWants.elems[j] - main_people.elems]) = p;
+            }
+        }
 
-        SNZ_ARENA_ARR_BEGIN(&main_fileArenaA, Person*);
-        void* beginning = main_fileArenaA.end;
-        for (int j = 0; j < p->wantsFromFile.count; j++) {
-            int64_t count = (void**)main_fileArenaA.end - (void**)beginning; // FIXME: kill me
-            main_pushToArenaIfNotInCollection(beginning, count, p->validWants.elems[j], &main_fileArenaA);
-        }
-        for (int j = i; j < main_people.count; j++) {
-            Person* other = &main_people.elems[j];
-            bool inAdj = false;
-            for (int k = 0; k < other->wantsFromFile.count; k++) {
-                if (other->validWants.elems[k] == p) {
-                    inAdj = true;
+        for (int i = 0; i < main_people.count; i++) {
+            Person* p = &main_people.elems[i];
+            snz_arenaTempScope(scratch) {
+                PersonPtrSet added = SNZ_HASH_SET_INIT(PersonPtrSet, scratch, p->validWants.count + wantedBy[i].count);
+                SNZ_ARENA_ARR_BEGIN(&main_fileArenaA, Person*);
+                for (int j = 0; j < p->validWants.count; j++) {
+                    Person* wanted = p->validWants.elems[j];
+                    if (SNZ_HASH_SET_INSERT(PersonPtrSet, &added, wanted)) {
+                        *SNZ_ARENA_PUSH(&main_fileArenaA, Person*) = wanted;
+                    }
                 }
+                for (int j = 0; j < wantedBy[i].count; j++) {
+                    Person* other = wantedBy[i].elems[j];
+                    if (other < p) { // only people from p onwards in the file, same as it's always been
+                        continue;
+                    } else if (SNZ_HASH_SET_INSERT(PersonPtrSet, &added, other)) {
+                        *SNZ_ARENA_PUSH(&main_fileArenaA, Person*) = other;
+                    }
+                }
+                p->adjacents = SNZ_ARENA_ARR_END_NAMED(&main_fileArenaA, Person*, PersonPtrSlice);
             }
-            if (!inAdj) {
-                continue;
-            }
-            int64_t count = (void**)main_fileArenaA.end - (void**)beginning; // FIXME: kill me
-            main_pushToArenaIfNotInCollection(beginning, count, &main_people.elems[j], &main_fileArenaA);
-        }
-        p->adjacents = SNZ_ARENA_ARR_END_NAMED(&main_fileArenaA, Person*, PersonPtrSlice);
 
-        // printf("\n\nadjs for %.*s:\n", (int)p->name.count, p->name.elems);
-        // for (int j = 0; j < p->adjacents.count; j++) {
-        //     Person* adj = p->adjacents.elems[j];
-        //     printf("%.*s, ", (int)adj->name.count, adj->name.elems);
-        // }
+            // printf("\n\nadjs for %.*s:\n", (int)p->name.count, p->name.elems);
+            // for (int j = 0; j < p->adjacents.count; j++) {
+            //     Person* adj = p->adjacents.elems[j];
+            //     printf("%.*s, ", (int)adj->name.count, adj->name.elems);
+            // }
+        }
     }
 
+    main_roomsMark = snz_arenaMark(&main_fileArenaA);
     main_autogroup(scratch);
     main_startMessageBox(snz_arenaFormatStr(scratch, "Imported file from '%s'.", main_loadedPath), false);
 }
@@ -592,6 +633,7 @@ void main_init(snz_Arena* scratch, SDL_Window* window) {
 
     main_fileArenaA = snz_arenaInit(10000000, "main file arena A");
     main_fileArenaB = snz_arenaInit(10000000, "main file arena B");
+    main_roomsMark = snz_arenaMark(&main_fileArenaA);
 
     int w, h, bpp;
     stbi_set_flip_vertically_on_load(1);
@@ -635,8 +677,12 @@ void main_messageBoxBuild(bool error, bool explicitClose, const char** message)
     }
 
     if (*fadeAnim > 0.001) {
-        int count = *message ? strlen(*message) : 0;
-        char* const messageCopy = SNZU_USE_ARRAY(char, count, "msg"); // FIXME: segfault potential if an error gets overwritten with a longer string because usearr doesn't cope w changing sizes
+        // length is kept across frames so that the copy keeps its size while no new message is coming in
+        uint64_t* const msgSize = SNZU_USE_MEM(uint64_t, "msgSize");
+        if (*message) {
+            *msgSize = strlen(*message) + 1;
+        }
+        char* const messageCopy = SNZU_USE_ARRAY(char, *msgSize, "msg");
         if (*message) {
             strcpy(messageCopy, *message);
         }
@@ -694,6 +740,140 @@ void main_messageBoxBuild(bool error, bool explicitClose, const char** message)
     *message = NULL;
 }
 
+// builds the row for main_people.elems[idx] into the selected box, see snzuc_scrollList
+void main_buildPeopleRow(uint64_t idx, void* userData) {
+    (void)userData;
+    Person* p = &main_people.elems[idx];
+    snzu_boxSetColor(p->genderColor);
+    snzu_boxSetCornerRadius(10);
+    snzu_boxSetBorder(BORDER_THICKNESS, HMM_LerpV4(p->genderColor, p->hoverAnim, COL_TEXT));
+    snzu_boxClipChildren(true);
+    snzu_boxScope() {
+        main_buildPerson(p, false, COL_TEXT);
+        snzu_boxAlignInParent(SNZU_AX_Y, SNZU_ALIGN_CENTER);
+        snzu_boxAlignInParent(SNZU_AX_X, SNZU_ALIGN_LEFT);
+
+        snzu_boxNew("others");
+        snzu_boxFillParent();
+        snzu_boxSetStartFromParentAx(main_peopleNameColWidth, SNZU_AX_X);
+        snzu_boxScope() {
+            for (int i = 0; i < p->wantsFromFile.count; i++) {
+                PersonWant w = p->wantsFromFile.elems[i];
+                if (w.person) {
+                    main_buildPerson(w.person, false, COL_TEXT);
+                } else {
+                    snzu_boxNewU64(i);
+                    snzu_boxSetDisplayStrLen(&main_font, COL_ERROR_TEXT, w.name.elems, w.name.count);
+                    snzu_boxSetSizeFitText(TEXT_PADDING);
+                }
+            }
+        }
+        snzu_boxOrderChildrenInRowRecurseAlignEnd(5, SNZU_AX_X);
+    }
+}
+
+// everything the people list shows that snzu can't see changing on its own, see snzu_boxSetCached
+// hover anims get eased outside of the list, so they go in through main_peopleHoverGeneration
+uint64_t main_peopleListHash() {
+    uint64_t h = snz_hashCombine(main_rosterGeneration, main_people.count);
+    uint32_t bits = 0;
+    memcpy(&bits, &main_peopleNameColWidth, sizeof(bits));
+    h = snz_hashCombine(h, bits);
+    return snz_hashCombine(h, main_peopleHoverGeneration);
+}
+
+void main_removeFromRoom(Room* room, Person* p) {
+    bool shift = false;
+    for (int i = 0; i < room->people.count; i++) {
+        if (room->people.elems[i] == p) {
+            shift = true;
+            continue;
+        }
+
+        if (shift) {
+            room->people.elems[i - 1] = room->people.elems[i];
+        }
+    }
+    if (shift) {
+        room->people.count--;
+    }
+}
+
+// builds the row for main_rooms.elems[idx] into the selected box, see snzuc_scrollList
+// userData is the scratch arena
+// the dragged person should already be taken out of every room
+void main_buildRoomRow(uint64_t idx, void* userData) {
+    snz_Arena* scratch = (snz_Arena*)userData;
+    Room* room = main_rooms.elems[idx];
+    int roomNumber = (int)idx + 1;
+
+    HMM_Vec4 numberColor = COL_TEXT;
+    numberColor.A = 0.5;
+    float roomNumberColWidth = snzr_strSize(&main_font, "200", 2, main_font.renderedSize).X;
+
+    const char* errString = NULL;
+    SNZ_ASSERT(room->people.count > 0, "empty room??");
+    HMM_Vec4 color = room->people.elems[0]->genderColor;
+
+    if (main_draggedPerson) {
+        snzu_Interaction* inter = SNZU_USE_MEM(snzu_Interaction, "inter");
+        snzu_boxSetInteractionOutput(inter, SNZU_IF_HOVER | SNZU_IF_ALLOW_EVENT_FALLTHROUGH);
+
+        if (inter->hovered) {
+            if (room->people.count < ROOM_MAX_PERSON_COUNT) {
+                color = HMM_Add(color, HMM_Sub(HMM_V4(1, 1, 1, 1), COL_HOVERED));
+                room->people.elems[room->people.count] = main_draggedPerson;
+                room->people.count++;
+            }
+        }
+    }
+
+    if (room->people.count <= 2) {
+        color = COL_PANEL_ERROR;
+        if (room->people.count == 1) {
+            errString = "only 1 person.";
+        } else {
+            errString = snz_arenaFormatStr(scratch, "only %lld people.", room->people.count);
+        }
+    }
+    snzu_boxSetColor(color);
+    snzu_boxSetCornerRadius(10);
+    snzu_boxClipChildren(true);
+    snzu_boxScope() {
+        snzu_boxNew("number");
+        snzu_boxSetDisplayStr(&main_font, numberColor, snz_arenaFormatStr(scratch, "%d", roomNumber));
+        snzu_boxSetSizeFitText(TEXT_PADDING);
+        snzu_boxSetSizeFromStartAx(SNZU_AX_X, roomNumberColWidth + 2 * TEXT_PADDING);
+
+        for (int i = 0; i < room->people.count; i++) {
+            Person* p = room->people.elems[i];
+            bool anyMatches = false;
+            for (int j = 0; j < p->validWants.count; j++) {
+                Person* wanted = p->validWants.elems[j];
+                if (main_personInPersonSlice(wanted, room->people)) {
+                    anyMatches = true;
+                    break;
+                }
+            }
+            if (!anyMatches && !errString) {
+                errString = snz_arenaFormatStr(scratch, "%.*s doesn't like anyone here.", (int)p->name.count, p->name.elems);
+            }
+            main_buildPerson(p, true, anyMatches ? COL_TEXT : COL_ERROR_TEXT);
+        }
+    }
+    snzu_boxOrderChildrenInRowRecurse(5, SNZU_AX_X);
+
+    snzu_boxScope() {
+        if (errString) {
+            snzu_boxNew("err");
+            snzu_boxSetDisplayStr(&main_font, COL_ERROR_TEXT, errString);
+            snzu_boxSetSizeFitText(TEXT_PADDING);
+            snzu_boxAlignInParent(SNZU_AX_X, SNZU_ALIGN_RIGHT);
+            snzu_boxAlignInParent(SNZU_AX_Y, SNZU_ALIGN_CENTER);
+        }
+    }
+}
+
 void main_loop(float dt, snz_Arena* scratch, snzu_Input inputs, HMM_Vec2 screenSize) {
     snzu_instanceSelect(&main_inst);
     snzu_frameStart(scratch, screenSize, dt);
@@ -740,55 +920,9 @@ void main_loop(float dt, snz_Arena* scratch, snzu_Input inputs, HMM_Vec2 screenS
             snzu_boxScope() {
                 snzu_boxNew("scroller");
                 snzu_boxSetSizeMarginFromParent(10);
-                snzu_boxScope() {
-                    float sizeOfPeopleCol = 0;
-                    for (int i = 0; i < main_people.count; i++) {
-                        Person* p = &main_people.elems[i];
-                        HMM_Vec2 s = snzr_strSize(&main_font, p->name.elems, p->name.count, main_font.renderedSize);
-                        sizeOfPeopleCol = SNZ_MAX(s.X, sizeOfPeopleCol);
-                    }
-                    float boxHeight = main_font.renderedSize + 2 * TEXT_PADDING;
-
-                    snzu_boxNew("margin");
-                    snzu_boxSetSizeMarginFromParent(5);
-                    snzu_boxScope() {
-                        for (int i = 0; i < main_people.count; i++) {
-                            snzu_boxNew(snz_arenaFormatStr(scratch, "%d", i));
-                            Person* p = &main_people.elems[i];
-                            snzu_boxSetColor(p->genderColor);
-                            snzu_boxSetCornerRadius(10);
-                            snzu_boxFillParent();
-                            snzu_boxSetSizeFromStartAx(SNZU_AX_Y, boxHeight);
-                            snzu_boxSetBorder(BORDER_THICKNESS, HMM_LerpV4(p->genderColor, p->hoverAnim, COL_TEXT));
-                            snzu_boxClipChildren(true);
-                            snzu_boxScope() {
-                                main_buildPerson(p, false, COL_TEXT, scratch);
-                                snzu_boxAlignInParent(SNZU_AX_Y, SNZU_ALIGN_CENTER);
-                                snzu_boxAlignInParent(SNZU_AX_X, SNZU_ALIGN_LEFT);
-
-                                snzu_boxNew("others");
-                                snzu_boxFillParent();
-                                snzu_boxSetStartFromParentAx(sizeOfPeopleCol, SNZU_AX_X);
-                                snzu_boxScope() {
-                                    for (int i = 0; i < p->wantsFromFile.count; i++) {
-                                        PersonWant w = p->wantsFromFile.elems[i];
-                                        if (w.person) {
-                                            main_buildPerson(w.person, false, COL_TEXT, scratch);
-                                        } else {
-                                            snzu_boxNew(snz_arenaFormatStr(scratch, "%s", w.name));
-                                            snzu_boxSetDisplayStrLen(&main_font, COL_ERROR_TEXT, w.name.elems, w.name.count);
-                                            snzu_boxSetSizeFitText(TEXT_PADDING);
-                                        }
-                                    }
-                                }
-                                snzu_boxOrderChildrenInRowRecurseAlignEnd(5, SNZU_AX_X);
-                            }
-                        }
-                    } // end margin
-                    snzu_boxOrderChildrenInRowRecurse(5, SNZU_AX_Y);
-                    snzu_boxSetSizeFitChildren();
-                } // end scroller
-                snzuc_scrollArea();
+                snzu_boxSetCached(main_peopleListHash());
+                float boxHeight = main_font.renderedSize + 2 * TEXT_PADDING;
+                snzuc_scrollList(main_people.count, boxHeight, 5, 5, main_buildPeopleRow, NULL);
             } // end left side
 
             snzu_boxNew("right side");
@@ -797,109 +931,17 @@ void main_loop(float dt, snz_Arena* scratch, snzu_Input inputs, HMM_Vec2 screenS
             snzu_boxScope() {
                 snzu_boxNew("scroller");
                 snzu_boxSetSizeMarginFromParent(10);
-                snzu_boxScope() {
-                    float boxHeight = main_font.renderedSize + 2 * TEXT_PADDING;
-                    snzu_boxNew("margin");
-                    snzu_boxSetSizeMarginFromParent(5);
-                    snzu_boxScope() {
-                        HMM_Vec4 numberColor = COL_TEXT;
-                        numberColor.A = 0.5;
-
-                        int roomNumber = 1;
-                        float roomNumberColWidth = snzr_strSize(&main_font, "200", 2, main_font.renderedSize).X;
-
-                        for (Room* room = main_firstRoom; room; (room = room->next, roomNumber++)) {
-                            const char* errString = NULL;
-                            snzu_boxNew(snz_arenaFormatStr(scratch, "%p", room));
-                            SNZ_ASSERT(room->people.count > 0, "empty room??");
-                            HMM_Vec4 color = room->people.elems[0]->genderColor;
-
-                            if (main_draggedPerson) {
-                                snzu_Interaction* inter = SNZU_USE_MEM(snzu_Interaction, "inter");
-                                snzu_boxSetInteractionOutput(inter, SNZU_IF_HOVER | SNZU_IF_ALLOW_EVENT_FALLTHROUGH);
-
-                                bool shift = false;
-                                for (int i = 0; i < room->people.count; i++) {
-                                    if (room->people.elems[i] == main_draggedPerson) {
-                                        shift = true;
-                                        continue;
-                                    }
-
-                                    if (shift) {
-                                        room->people.elems[i - 1] = room->people.elems[i];
-                                    }
-                                }
-                                if (shift) {
-                                    room->people.count--;
-                                }
-
-                                if (inter->hovered) {
-                                    if (room->people.count < ROOM_MAX_PERSON_COUNT) {
-                                        color = HMM_Add(color, HMM_Sub(HMM_V4(1, 1, 1, 1), COL_HOVERED));
-                                        room->people.elems[room->people.count] = main_draggedPerson;
-                                        room->people.count++;
-                                    }
-                                } else {
-                                    for (int i = 0; i < room->people.count; i++) {
-                                        if (room->people.elems[i] == main_draggedPerson) {
-                                            // room->people.elems[i] =
-                                        }
-                                    }
-                                }
-                            }
-
-                            if (room->people.count <= 2) {
-                                color = COL_PANEL_ERROR;
-                                if (room->people.count == 1) {
-                                    errString = "only 1 person.";
-                                } else {
-                                    errString = snz_arenaFormatStr(scratch, "only %lld people.", room->people.count);
-                                }
-                            }
-                            snzu_boxSetColor(color);
-                            snzu_boxSetCornerRadius(10);
-                            snzu_boxClipChildren(true);
-                            snzu_boxFillParent();
-                            snzu_boxSetSizeFromStartAx(SNZU_AX_Y, boxHeight);
-                            snzu_boxScope() {
-                                snzu_boxNew("number");
-                                snzu_boxSetDisplayStr(&main_font, numberColor, snz_arenaFormatStr(scratch, "%d", roomNumber));
-                                snzu_boxSetSizeFitText(TEXT_PADDING);
-                                snzu_boxSetSizeFromStartAx(SNZU_AX_X, roomNumberColWidth + 2 * TEXT_PADDING);
-
-                                for (int i = 0; i < room->people.count; i++) {
-                                    Person* p = room->people.elems[i];
-                                    bool anyMatches = false;
-                                    for (int j = 0; j < p->wantsFromFile.count; j++) {
-                                        Person* wanted = p->validWants.elems[j];
-                                        if (main_personInPersonSlice(wanted, room->people)) {
-                                            anyMatches = true;
-                                            break;
-                                        }
-                                    }
-                                    if (!anyMatches && !errString) {
-                                        errString = snz_arenaFormatStr(scratch, "%.*s doesn't like anyone here.", (int)p->name.count, p->name.elems);
-                                    }
-                                    main_buildPerson(p, true, anyMatches ? COL_TEXT : COL_ERROR_TEXT, scratch);
-                                }
-                            }
-                            snzu_boxOrderChildrenInRowRecurse(5, SNZU_AX_X);
-
-                            snzu_boxScope() {
-                                if (errString) {
-                                    snzu_boxNew("err");
-                                    snzu_boxSetDisplayStr(&main_font, COL_ERROR_TEXT, errString);
-                                    snzu_boxSetSizeFitText(TEXT_PADDING);
-                                    snzu_boxAlignInParent(SNZU_AX_X, SNZU_ALIGN_RIGHT);
-                                    snzu_boxAlignInParent(SNZU_AX_Y, SNZU_ALIGN_CENTER);
-                                }
-                            }
-                        }
-                    } // end margin
-                    snzu_boxOrderChildrenInRowRecurse(5, SNZU_AX_Y);
-                    snzu_boxSetSizeFitChildren();
-                } // end scroller
-                snzuc_scrollArea();
+
+                // rooms that are scrolled off still need to let go of the dragged person, the room that
+                // is hovered (and so built) picks them back up
+                if (main_draggedPerson) {
+                    for (int i = 0; i < main_rooms.count; i++) {
+                        main_removeFromRoom(main_rooms.elems[i], main_draggedPerson);
+                    }
+                }
+
+                float boxHeight = main_font.renderedSize + 2 * TEXT_PADDING;
+                snzuc_scrollList(main_rooms.count, boxHeight, 5, 5, main_buildRoomRow, scratch);
             } // end right side
 
             snzu_boxNew("center bar");
@@ -914,12 +956,41 @@ void main_loop(float dt, snz_Arena* scratch, snzu_Input inputs, HMM_Vec2 screenS
             if (main_draggedPerson) {
                 p->hovered = false;
             }
+            float oldHoverAnim = p->hoverAnim;
             snzu_easeExp(&p->hoverAnim, p->hovered, 23);
+            if (p->hoverAnim != oldHoverAnim) {
+                main_peopleHoverGeneration++;
+            }
             p->hovered = false;
         }
 
         main_messageBoxBuild(_main_messageBoxShouldBeError, _main_messageBoxShouldBeError, &_main_messageBoxMessageSignal);
 
+#ifdef SNZ_ARENA_INSTRUMENT
+        if (inputs.keyAction == SNZU_ACT_DOWN && inputs.keyCode == SDLK_F3) {
+            main_showArenaStats = !main_showArenaStats;
+        }
+        if (main_showArenaStats) {
+            snzuc_arenaStatsPanel(&main_font, scratch);
+        }
+#endif
+
+#ifdef SNZ_PROFILE
+        if (inputs.keyAction == SNZU_ACT_DOWN && inputs.keyCode == SDLK_F4) {
+            main_showProfile = !main_showProfile;
+        }
+        if (inputs.keyAction == SNZU_ACT_DOWN && inputs.keyCode == SDLK_F5) {
+            if (snz_profileDumpCsv(PROFILE_CSV_PATH)) {
+                main_startMessageBox("Wrote profile to '" PROFILE_CSV_PATH "'.", false);
+            } else {
+                main_startMessageBox("Couldn't write '" PROFILE_CSV_PATH "'.", true);
+            }
+        }
+        if (main_showProfile) {
+            snzuc_profilePanel(&main_font, scratch);
+        }
+#endif
+
         snzu_boxNew("dragDropBox");
         snzu_boxFillParent();
         snzu_Interaction* inter = SNZU_USE_MEM(snzu_Interaction, "inter");
@@ -949,5 +1020,10 @@ void main_loop(float dt, snz_Arena* scratch, snzu_Input inputs, HMM_Vec2 screenS
 }
 
 int main() {
+#ifdef SNZ_TESTS
+    snz_arenaTests();
+    snz_containerTests();
+    return 0;
+#endif
     snz_main("Sorting hat", "res/sort_hat_logo.bmp", main_init, main_loop);
 }
\ No newline at end of file
@@ -6,10 +6,16 @@
 #include <malloc.h>
 #include <memory.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #define SDL_MAIN_HANDLED
 #include "GLAD/include/glad/glad.h"
 #include "HMM/HandmadeMath.h"
@@ -85,25 +91,88 @@ SNZ_SLICE(HMM_Vec3);
 // ARENAS ======================================================================
 
 // fixed size, ungrowable
-// zeroes memory on free and init
+// memory is zeroed lazily when it gets pushed, so clears and pops are O(1)
 // FIXME: make growable
 // FIXME: testing
 typedef struct {
     void* start;
     void* end;
+    void* dirtyEnd;  // high water mark, everything past this is known to still be zeroed from init
     int64_t reserved;
     const char* name;  // used for debug messages only
 
     int64_t arrModeElemSize;
     int64_t arrModeElemCount;
     const char* arrModeTypeName;  // used for debug only
+
+#ifdef SNZ_ARENA_INSTRUMENT
+    int64_t statsIdx;  // index + 1 into _snz_arenaStats.arenas, 0 when not registered yet, -1 for untracked (pooled) arenas
+#endif
 } snz_Arena;
 
+// routes pushes through the instrumented path when it's compiled in, file and line are dropped otherwise
+#ifdef SNZ_ARENA_INSTRUMENT
+#define _SNZ_ARENA_PUSH_AT(arena, size, file, line) _snz_arenaPushTracked((arena), (size), (file), (line))
+#else
+#define _SNZ_ARENA_PUSH_AT(arena, size, file, line) snz_arenaPush((arena), (size))
+#endif
+
 // returns a pointer to memory that is zeroed
-#define SNZ_ARENA_PUSH(bump, T) ((T*)(snz_arenaPush((bump), sizeof(T))))
+#define SNZ_ARENA_PUSH(bump, T) ((T*)(_SNZ_ARENA_PUSH_AT((bump), sizeof(T), __FILE__, __LINE__)))
 
 // returns a pointer to memory that is zeroed
-#define SNZ_ARENA_PUSH_ARR(bump, count, T) (T*)(snz_arenaPush((bump), sizeof(T) * (count)))
+#define SNZ_ARENA_PUSH_ARR(bump, count, T) (T*)(_SNZ_ARENA_PUSH_AT((bump), sizeof(T) * (count), __FILE__, __LINE__))
+
+// ARENA INSTRUMENTATION =======================================================
+// opt in by compiling with -DSNZ_ARENA_INSTRUMENT
+// records bytes and counts per SNZ_ARENA_PUSH call site, and usage and peaks per arena
+// frame counters roll over on snz_arenaStatsFrameEnd, which snz_main calls every frame
+// not thread safe, only push to tracked arenas from the main thread
+#ifdef SNZ_ARENA_INSTRUMENT
+
+typedef struct {
+    const char* file;
+    int64_t line;
+    int64_t arenaIdx;  // index into snz_arenaStatsArenas()
+    int64_t totalBytes;
+    int64_t totalCount;
+    int64_t frameBytes;  // for the frame in progress
+    int64_t frameCount;
+    int64_t lastFrameBytes;
+    int64_t lastFrameCount;
+} snz_ArenaSiteStats;
+SNZ_SLICE(snz_ArenaSiteStats);
+
+typedef struct {
+    snz_Arena* arena;  // null once the arena has been deinitialized
+    const char* name;
+    int64_t reserved;
+    int64_t used;  // as of the last push or frame end
+    int64_t framePeak;  // for the frame in progress
+    int64_t lastFramePeak;
+    int64_t maxPeak;  // over all frames
+    int64_t frameBytes;
+    int64_t lastFrameBytes;
+    float bytesPerSec;  // allocation rate over the last frame
+} snz_ArenaUsageStats;
+SNZ_SLICE(snz_ArenaUsageStats);
+
+#define _SNZ_ARENA_STATS_MAX_SITES 1024
+#define _SNZ_ARENA_STATS_SITE_TABLE_SIZE (_SNZ_ARENA_STATS_MAX_SITES * 2)
+#define _SNZ_ARENA_STATS_MAX_ARENAS 32
+
+struct {
+    snz_ArenaSiteStats sites[_SNZ_ARENA_STATS_MAX_SITES];
+    int64_t siteCount;
+    int32_t siteTable[_SNZ_ARENA_STATS_SITE_TABLE_SIZE];  // index + 1 into sites, 0 is empty, linearly probed
+
+    snz_ArenaUsageStats arenas[_SNZ_ARENA_STATS_MAX_ARENAS];
+    int64_t arenaCount;
+} _snz_arenaStats;
+
+#endif
+
+// ARENA INSTRUMENTATION =======================================================
 
 snz_Arena snz_arenaInit(int64_t size, const char* name) {
     snz_Arena a = { 0 };
@@ -112,34 +181,165 @@ snz_Arena snz_arenaInit(int64_t size, const char* name) {
     a.start = calloc(1, size);
     SNZ_ASSERTF(a.start != NULL, "arena alloc for '%s' failed.", a.name);
     a.end = a.start;
+    a.dirtyEnd = a.start;
     return a;
 }
 
 void snz_arenaDeinit(snz_Arena* a) {
+#ifdef SNZ_ARENA_INSTRUMENT
+    if (a->statsIdx) {
+        _snz_arenaStats.arenas[a->statsIdx - 1].arena = NULL;
+    }
+#endif
     free(a->start);
     memset(a, 0, sizeof(*a));
 }
 
-// FIXME: file and line of req.
+// compile with SNZ_ARENA_INSTRUMENT to see where pushes are coming from
+// 16 so that SSE types (HMM vectors) are safe to push
+#define _SNZ_ARENA_ALIGN 16
+
+// what a push of size actually takes up when not in array mode, containers use this to know what they own
+static int64_t _snz_arenaPaddedSize(int64_t size) {
+    return (size + _SNZ_ARENA_ALIGN - 1) & ~(int64_t)(_SNZ_ARENA_ALIGN - 1);
+}
+
 void* snz_arenaPush(snz_Arena* a, int64_t size) {
     SNZ_ASSERTF(a->arrModeElemSize == 0 || a->arrModeElemSize == size,
                 "arena push failed for '%s'. Active array elem: '%s' (size %lld), requested: %lld",
                 a->name, a->arrModeTypeName, a->arrModeElemSize, size);
     a->arrModeElemCount++;  // this will always be correct when inside arr mode, and it will just get reset on enter, so we don't need to branch here.
 
+    char* o = (char*)(a->end);
     if (!a->arrModeElemSize) {  // only align allocations when not in array mode
-        size += sizeof(uint64_t) - (size % sizeof(uint64_t));
+        // start is rounded up too, because an array could have left end anywhere
+        o = (char*)(((uintptr_t)o + _SNZ_ARENA_ALIGN - 1) & ~(uintptr_t)(_SNZ_ARENA_ALIGN - 1));
+        size = _snz_arenaPaddedSize(size);
     }
-    char* o = (char*)(a->end);
     if (!(o + size < (char*)(a->start) + a->reserved)) {
         SNZ_ASSERTF(false,
                     "arena push failed for '%s'. Cap: %lld, Used: %llu, Requested: %llu",
                     a->name, a->reserved, (uint64_t)a->end - (uint64_t)a->start, size);
     }
     a->end = o + size;
+
+    // only memory below the high water mark can have been used before, everything above is still zero from init
+    char* dirtyEnd = (char*)(a->dirtyEnd);
+    if (o < dirtyEnd) {
+        memset(o, 0, SNZ_MIN(dirtyEnd, (char*)(a->end)) - o);
+    }
+    if ((char*)(a->end) > dirtyEnd) {
+        a->dirtyEnd = a->end;
+    }
     return o;
 }
 
+#ifdef SNZ_ARENA_INSTRUMENT
+
+static snz_ArenaUsageStats* _snz_arenaStatsGetArena(snz_Arena* a) {
+    if (!a->statsIdx) {
+        SNZ_ASSERTF(_snz_arenaStats.arenaCount < _SNZ_ARENA_STATS_MAX_ARENAS,
+                    "arena stats failed for '%s', too many tracked arenas.", a->name);
+        _snz_arenaStats.arenas[_snz_arenaStats.arenaCount] = (snz_ArenaUsageStats){
+            .arena = a,
+            .name = a->name,
+            .reserved = a->reserved,
+        };
+        _snz_arenaStats.arenaCount++;
+        a->statsIdx = _snz_arenaStats.arenaCount;
+    }
+    return &_snz_arenaStats.arenas[a->statsIdx - 1];
+}
+
+static snz_ArenaSiteStats* _snz_arenaStatsGetSite(const char* file, int64_t line, int64_t arenaIdx) {
+    uint64_t hash = (uint64_t)file ^ ((uint64_t)line * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)arenaIdx << 48);
+    hash ^= hash >> 29;
+    uint64_t slot = hash % _SNZ_ARENA_STATS_SITE_TABLE_SIZE;
+    while (true) {
+        int32_t idx = _snz_arenaStats.siteTable[slot];
+        if (idx == 0) {
+            break;
+        }
+        snz_ArenaSiteStats* site = &_snz_arenaStats.sites[idx - 1];
+        if (site->file == file && site->line == line && site->arenaIdx == arenaIdx) {
+            return site;
+        }
+        slot = (slot + 1) % _SNZ_ARENA_STATS_SITE_TABLE_SIZE;
+    }
+
+    SNZ_ASSERTF(_snz_arenaStats.siteCount < _SNZ_ARENA_STATS_MAX_SITES,
+                "arena stats failed, too many call sites. (new one was %s:%lld)", file, line);
+    snz_ArenaSiteStats* site = &_snz_arenaStats.sites[_snz_arenaStats.siteCount];
+    _snz_arenaStats.siteCount++;
+    _snz_arenaStats.siteTable[slot] = (int32_t)_snz_arenaStats.siteCount;
+    *site = (snz_ArenaSiteStats){
+        .file = file,
+        .line = line,
+        .arenaIdx = arenaIdx,
+    };
+    return site;
+}
+
+void* _snz_arenaPushTracked(snz_Arena* a, int64_t size, const char* file, int64_t line) {
+    if (a->statsIdx < 0) {  // pooled arenas get pushed to from other threads, and the stats aren't thread safe
+        return snz_arenaPush(a, size);
+    }
+
+    int64_t used = (char*)(a->end) - (char*)(a->start);
+    SNZ_ASSERTF(used + size < a->reserved,
+                "arena push from %s:%lld failed for '%s'. Cap: %lld, Used: %lld, Requested: %lld",
+                file, line, a->name, a->reserved, used, size);
+    void* out = snz_arenaPush(a, size);
+
+    snz_ArenaUsageStats* arenaStats = _snz_arenaStatsGetArena(a);
+    arenaStats->used = (char*)(a->end) - (char*)(a->start);
+    arenaStats->framePeak = SNZ_MAX(arenaStats->framePeak, arenaStats->used);
+    arenaStats->frameBytes += size;
+
+    snz_ArenaSiteStats* site = _snz_arenaStatsGetSite(file, line, a->statsIdx - 1);
+    site->totalBytes += size;
+    site->totalCount++;
+    site->frameBytes += size;
+    site->frameCount++;
+    return out;
+}
+
+// rolls per frame counters over, dt is used for the allocation rate
+void snz_arenaStatsFrameEnd(float dt) {
+    for (int64_t i = 0; i < _snz_arenaStats.arenaCount; i++) {
+        snz_ArenaUsageStats* s = &_snz_arenaStats.arenas[i];
+        s->lastFramePeak = s->framePeak;
+        s->maxPeak = SNZ_MAX(s->maxPeak, s->framePeak);
+        s->lastFrameBytes = s->frameBytes;
+        s->bytesPerSec = (dt > 0) ? (s->frameBytes / dt) : 0;
+        s->frameBytes = 0;
+        if (s->arena) {
+            s->used = (char*)(s->arena->end) - (char*)(s->arena->start);
+        }
+        s->framePeak = s->used;
+    }
+
+    for (int64_t i = 0; i < _snz_arenaStats.siteCount; i++) {
+        snz_ArenaSiteStats* s = &_snz_arenaStats.sites[i];
+        s->lastFrameBytes = s->frameBytes;
+        s->lastFrameCount = s->frameCount;
+        s->frameBytes = 0;
+        s->frameCount = 0;
+    }
+}
+
+// should be treated as read only, valid until the next tracked push
+snz_ArenaSiteStatsSlice snz_arenaStatsSites() {
+    return (snz_ArenaSiteStatsSlice){ .elems = _snz_arenaStats.sites, .count = _snz_arenaStats.siteCount };
+}
+
+// should be treated as read only, indexed by snz_ArenaSiteStats.arenaIdx
+snz_ArenaUsageStatsSlice snz_arenaStatsArenas() {
+    return (snz_ArenaUsageStatsSlice){ .elems = _snz_arenaStats.arenas, .count = _snz_arenaStats.arenaCount };
+}
+
+#endif
+
 void snz_arenaPop(snz_Arena* a, int64_t size) {
     SNZ_ASSERTF(a->arrModeElemSize == 0,
                 "arena pop failed for '%s'. Active array elem: '%s'",
@@ -148,8 +348,7 @@ void snz_arenaPop(snz_Arena* a, int64_t size) {
     SNZ_ASSERTF(size <= (c - (char*)(a->start)),
                 "arena pop failed for '%s', tried to pop %lld bytes, only %lld remaining",
                 a->name, size, (uint64_t)a->end - (uint64_t)a->start);
-    a->end = c - size;
-    memset(a->end, 0, size);
+    a->end = c - size;  // no zeroing, that happens when the memory gets pushed again
 }
 
 void snz_arenaClear(snz_Arena* a) {
@@ -159,28 +358,68 @@ void snz_arenaClear(snz_Arena* a) {
     SNZ_ASSERTF(a->arrModeElemSize == 0,
                 "arena clear failed for '%s'. Active array elem: '%s'",
                 a->name, a->arrModeTypeName);
-    memset(a->start, 0, (int64_t)(a->end) - (int64_t)(a->start));
-    a->end = a->start;
+    a->end = a->start;  // no zeroing, that happens when the memory gets pushed again
 }
 
-char* snz_arenaCopyStr(snz_Arena* arena, const char* str) {
-    char* chars = SNZ_ARENA_PUSH_ARR(arena, strlen(str) + 1, char);
+// file and line are the callers, so instrumented builds attribute the push correctly
+#define snz_arenaCopyStr(arena, str) _snz_arenaCopyStrAt((arena), (str), __FILE__, __LINE__)
+char* _snz_arenaCopyStrAt(snz_Arena* arena, const char* str, const char* file, int64_t line) {
+    (void)file, (void)line;
+    char* chars = (char*)_SNZ_ARENA_PUSH_AT(arena, strlen(str) + 1, file, line);
     strcpy(chars, str);
     return chars;
 }
 
-char* snz_arenaFormatStr(snz_Arena* arena, const char* fmt, ...) {
+// file and line are the callers, so instrumented builds attribute the push correctly
+#define snz_arenaFormatStr(arena, ...) _snz_arenaFormatStrAt((arena), __FILE__, __LINE__, __VA_ARGS__)
+char* _snz_arenaFormatStrAt(snz_Arena* arena, const char* file, int64_t line, const char* fmt, ...) {
+    (void)file, (void)line;
     va_list args;
     va_start(args, fmt);
 
     uint64_t len = vsnprintf(NULL, 0, fmt, args);
-    char* out = SNZ_ARENA_PUSH_ARR(arena, len + 1, char);
+    char* out = (char*)_SNZ_ARENA_PUSH_AT(arena, len + 1, file, line);
     vsprintf_s(out, len + 1, fmt, args);
 
     va_end(args);
     return out;
 }
 
+// a savepoint on an arena, everything pushed after it was taken gets released when it is restored
+typedef struct {
+    snz_Arena* arena;
+    void* end;
+    int64_t arrModeElemSize;
+    int64_t arrModeElemCount;
+} snz_ArenaMark;
+
+// may be taken inside of array mode, but must then be restored inside the same array
+snz_ArenaMark snz_arenaMark(snz_Arena* a) {
+    return (snz_ArenaMark){
+        .arena = a,
+        .end = a->end,
+        .arrModeElemSize = a->arrModeElemSize,
+        .arrModeElemCount = a->arrModeElemCount,
+    };
+}
+
+// releases everything pushed since the mark was taken, O(1) because zeroing happens on the next push
+void snz_arenaRestore(snz_ArenaMark mark) {
+    snz_Arena* a = mark.arena;
+    SNZ_ASSERTF(a->arrModeElemSize == mark.arrModeElemSize,
+                "arena restore failed for '%s'. Array mode changed since mark, active array elem: '%s'",
+                a->name, a->arrModeTypeName);
+    SNZ_ASSERTF((char*)(mark.end) <= (char*)(a->end),
+                "arena restore failed for '%s', mark is past the end of the arena (already restored or cleared?)",
+                a->name);
+    a->end = mark.end;
+    a->arrModeElemCount = mark.arrModeElemCount;
+}
+
+// everything pushed to arenaPtr inside of the scope gets released when the scope exits
+// breaking or returning out of the scope skips the restore, so don't
+#define snz_arenaTempScope(arenaPtr) for (snz_ArenaMark _mark_ = snz_arenaMark(arenaPtr); _mark_.arena; snz_arenaRestore(_mark_), _mark_.arena = NULL)
+
 #define SNZ_ARENA_ARR_BEGIN(arena, T) _snz_arenaArrBegin(arena, sizeof(T), #T)
 void _snz_arenaArrBegin(snz_Arena* a, int64_t elemSize, const char* elemName) {
     SNZ_ASSERTF(a->arrModeElemSize == 0,
@@ -204,6 +443,630 @@ void _snz_arenaArrEnd(snz_Arena* a, int64_t elemSize) {
     a->arrModeTypeName = NULL;
 }
 
+// ARENA POOL ==================================================================
+// hands out scratch arenas to worker threads, checking out and returning are lock free
+// an arena belongs to exactly one thread while checked out, so array mode and pushes need no syncing
+// workers can pass a finished arena (and a pointer to a result inside of it) back through
+// snz_arenaPoolFinish, the consumer gets it from snz_arenaPoolTakeFinished without any copying,
+// and then returns the arena once it is done with the result.
+
+typedef struct {
+    snz_Arena arena;  // must be first, arena ptrs handed out are cast back to entries
+    _Atomic uint32_t next;  // index + 1 of the next entry in whichever list this is in, 0 is the end
+    void* result;  // set by snz_arenaPoolFinish, only valid while in the finished list
+} _snz_ArenaPoolEntry;
+
+typedef struct {
+    _snz_ArenaPoolEntry* entries;
+    int64_t entryCount;
+
+    // low 32 bits are an entry index + 1 (0 is empty), high 32 are a tag bumped on every change to avoid ABA
+    _Atomic uint64_t freeHead;
+    _Atomic uint64_t finishedHead;
+} snz_ArenaPool;
+
+static void _snz_arenaPoolListPush(snz_ArenaPool* pool, _Atomic uint64_t* head, uint32_t idx) {
+    uint64_t old = atomic_load(head);
+    uint64_t new = 0;
+    do {
+        atomic_store_explicit(&pool->entries[idx].next, (uint32_t)old, memory_order_relaxed);
+        new = ((((old >> 32) + 1) << 32) | (idx + 1));
+    } while (!atomic_compare_exchange_weak(head, &old, new));
+}
+
+// returns -1 when the list is empty
+static int64_t _snz_arenaPoolListPop(snz_ArenaPool* pool, _Atomic uint64_t* head) {
+    uint64_t old = atomic_load(head);
+    while (true) {
+        uint32_t top = (uint32_t)old;
+        if (top == 0) {
+            return -1;
+        }
+        // next may be stale if someone else popped first, but then the tag changed and the CAS fails
+        uint32_t next = atomic_load_explicit(&pool->entries[top - 1].next, memory_order_relaxed);
+        uint64_t new = ((((old >> 32) + 1) << 32) | next);
+        if (atomic_compare_exchange_weak(head, &old, new)) {
+            return top - 1;
+        }
+    }
+}
+
+static _snz_ArenaPoolEntry* _snz_arenaPoolEntryFromArena(snz_ArenaPool* pool, snz_Arena* arena) {
+    _snz_ArenaPoolEntry* e = (_snz_ArenaPoolEntry*)arena;
+    SNZ_ASSERTF(e >= pool->entries && e < pool->entries + pool->entryCount,
+                "arena '%s' does not belong to this pool.", arena->name);
+    return e;
+}
+
+// not thread safe, should be done before any workers start
+snz_ArenaPool snz_arenaPoolInit(int64_t arenaCount, int64_t arenaSize, const char* name) {
+    SNZ_ASSERTF(arenaCount > 0 && arenaCount < UINT32_MAX, "arena pool init for '%s' failed, invalid count: %lld", name, arenaCount);
+    snz_ArenaPool pool = { 0 };
+    pool.entryCount = arenaCount;
+    pool.entries = calloc(arenaCount, sizeof(*pool.entries));
+    SNZ_ASSERTF(pool.entries != NULL, "arena pool alloc for '%s' failed.", name);
+    atomic_init(&pool.freeHead, 0);
+    atomic_init(&pool.finishedHead, 0);
+    for (int64_t i = 0; i < arenaCount; i++) {
+        pool.entries[i].arena = snz_arenaInit(arenaSize, name);
+#ifdef SNZ_ARENA_INSTRUMENT
+        pool.entries[i].arena.statsIdx = -1;
+#endif
+    }
+    // push in reverse so the first checkout gets the first arena
+    for (int64_t i = arenaCount - 1; i >= 0; i--) {
+        _snz_arenaPoolListPush(&pool, &pool.freeHead, (uint32_t)i);
+    }
+    return pool;
+}
+
+// not thread safe, every arena should have been returned and no workers should be using the pool
+void snz_arenaPoolDeinit(snz_ArenaPool* pool) {
+    for (int64_t i = 0; i < pool->entryCount; i++) {
+        snz_arenaDeinit(&pool->entries[i].arena);
+    }
+    free(pool->entries);
+    memset(pool, 0, sizeof(*pool));
+}
+
+// returns an empty arena that the calling thread owns until it is returned or finished
+// returns NULL when every arena is checked out
+snz_Arena* snz_arenaPoolCheckout(snz_ArenaPool* pool) {
+    int64_t idx = _snz_arenaPoolListPop(pool, &pool->freeHead);
+    if (idx < 0) {
+        return NULL;
+    }
+    return &pool->entries[idx].arena;
+}
+
+// clears the arena and makes it available for checkout again, may be called from any thread
+void snz_arenaPoolReturn(snz_ArenaPool* pool, snz_Arena* arena) {
+    _snz_ArenaPoolEntry* e = _snz_arenaPoolEntryFromArena(pool, arena);
+    snz_arenaClear(arena);
+    e->result = NULL;
+    _snz_arenaPoolListPush(pool, &pool->freeHead, (uint32_t)(e - pool->entries));
+}
+
+// gives up ownership of the arena to whoever calls snz_arenaPoolTakeFinished
+// result should point to something inside of arena, like a slice, or be NULL
+void snz_arenaPoolFinish(snz_ArenaPool* pool, snz_Arena* arena, void* result) {
+    _snz_ArenaPoolEntry* e = _snz_arenaPoolEntryFromArena(pool, arena);
+    e->result = result;
+    _snz_arenaPoolListPush(pool, &pool->finishedHead, (uint32_t)(e - pool->entries));
+}
+
+// takes ownership of a finished arena, outResult is set to the result that was passed when it was finished
+// returns NULL if no arenas are finished. Results are not in any particular order.
+// the caller should snz_arenaPoolReturn the arena once it's done with the result
+snz_Arena* snz_arenaPoolTakeFinished(snz_ArenaPool* pool, void** outResult) {
+    int64_t idx = _snz_arenaPoolListPop(pool, &pool->finishedHead);
+    if (idx < 0) {
+        return NULL;
+    }
+    *outResult = pool->entries[idx].result;
+    return &pool->entries[idx].arena;
+}
+
+// ARENA POOL ==================================================================
+
+// CONTAINERS ==================================================================
+// typed containers generated by macros, all memory comes from an arena
+// growing either extends in place (if the container is the last thing in the arena) or leaves the old memory behind,
+// so these work best in scratch arenas or ones dedicated to the container
+
+// grows an array of elems to hold at least minCapacity, in place if it was the last push in the arena.
+// new space is zeroed, elems may be moved. file and line are the callers, so instrumented builds attribute the push correctly
+static void _snz_dynArrGrow(snz_Arena* arena, void** elems, int64_t* capacity, int64_t* reservedBytes, int64_t elemSize, int64_t minCapacity, const char* file, int64_t line) {
+    (void)file, (void)line;
+    int64_t newCapacity = SNZ_MAX(*capacity * 2, 8);
+    newCapacity = SNZ_MAX(newCapacity, minCapacity);
+
+    char* blockEnd = (char*)(*elems) + *reservedBytes;
+    if (*elems != NULL && blockEnd == (char*)(arena->end)) {
+        int64_t extra = newCapacity * elemSize - *reservedBytes;
+        int64_t padded = _snz_arenaPaddedSize(extra);
+        _SNZ_ARENA_PUSH_AT(arena, extra, file, line);
+        *reservedBytes += padded;
+    } else {
+        void* newElems = _SNZ_ARENA_PUSH_AT(arena, newCapacity * elemSize, file, line);
+        if (*elems != NULL) {
+            memcpy(newElems, *elems, *capacity * elemSize);
+        }
+        *elems = newElems;
+        *reservedBytes = _snz_arenaPaddedSize(newCapacity * elemSize);
+    }
+    *capacity = *reservedBytes / elemSize;
+}
+
+// growable array, elems may move when pushed to so don't hold pointers into it across pushes
+// may be zero initialized as long as arena is set
+// use SNZ_DYNARR_INIT and SNZ_DYNARR_PUSH so that growth is attributed to the caller
+#define SNZ_DYNARR_NAMED(T, name)                                                                   \
+    typedef struct {                                                                                \
+        T* elems;                                                                                   \
+        int64_t count;                                                                              \
+        int64_t capacity;                                                                           \
+        int64_t reservedBytes;                                                                      \
+        snz_Arena* arena;                                                                           \
+    } name;                                                                                         \
+                                                                                                    \
+    static inline name name##_initAt(snz_Arena* arena, int64_t initialCapacity, const char* file, int64_t line) { \
+        name arr = { .arena = arena };                                                              \
+        if (initialCapacity > 0) {                                                                  \
+            _snz_dynArrGrow(arena, (void**)&arr.elems, &arr.capacity, &arr.reservedBytes,           \
+                            sizeof(T), initialCapacity, file, line);                                \
+        }                                                                                           \
+        return arr;                                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    /* returns a zeroed elem at the end of the array */                                            \
+    static inline T* name##_pushAt(name* arr, const char* file, int64_t line) {                     \
+        if (arr->count >= arr->capacity) {                                                          \
+            _snz_dynArrGrow(arr->arena, (void**)&arr->elems, &arr->capacity, &arr->reservedBytes,   \
+                            sizeof(T), arr->count + 1, file, line);                                 \
+        }                                                                                           \
+        T* out = &arr->elems[arr->count];                                                           \
+        arr->count++;                                                                               \
+        memset(out, 0, sizeof(T));                                                                  \
+        return out;                                                                                 \
+    }                                                                                               \
+    static inline T* name##_pushAt(name* arr, const char* file, int64_t line) /* redeclared so uses need a semicolon like SNZ_SLICE */
+
+#define SNZ_DYNARR(T) SNZ_DYNARR_NAMED(T, T##DynArr)
+
+// name is the array type name, arr should be a ptr to one
+#define SNZ_DYNARR_INIT(name, arena, initialCapacity) name##_initAt((arena), (initialCapacity), __FILE__, __LINE__)
+#define SNZ_DYNARR_PUSH(name, arr) name##_pushAt((arr), __FILE__, __LINE__)
+
+// 64 bit hash of some bytes, fnv 1a with a murmur finalizer so low bits are usable
+static uint64_t _snz_hashBytes(const void* data, int64_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (int64_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// mixes v into h, order matters
+uint64_t snz_hashCombine(uint64_t h, uint64_t v) {
+    uint64_t pair[2] = { h, v };
+    return _snz_hashBytes(pair, sizeof(pair));
+}
+
+// swiss table style open addressing. Every slot has a control byte that is either empty, deleted,
+// or the low 7 bits of its keys hash. Probing looks at a whole group of 16 control bytes at once (with SSE2
+// when it's available), and only compares keys in slots where those 7 bits matched.
+// keys are compared bytewise, so they shouldn't have padding in them.
+#define _SNZ_HASH_GROUP_SIZE 16
+#define _SNZ_HASH_CTRL_EMPTY ((int8_t)-128)
+#define _SNZ_HASH_CTRL_DELETED ((int8_t)-2)
+
+typedef struct {
+    int8_t* ctrl;
+    uint8_t* keys;
+    uint8_t* vals;  // null when valSize is 0 (sets)
+    int64_t capacity;  // 0 or a power of 2 that is at least the group size
+    int64_t count;
+    int64_t deletedCount;
+    int64_t keySize;
+    int64_t valSize;
+    snz_Arena* arena;
+} _snz_HashTable;
+
+// bit i set when ctrl[i] == b
+static uint32_t _snz_hashGroupMatch(const int8_t* ctrl, int8_t b) {
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(b)));
+#else
+    uint32_t out = 0;
+    for (int i = 0; i < _SNZ_HASH_GROUP_SIZE; i++) {
+        out |= (uint32_t)(ctrl[i] == b) << i;
+    }
+    return out;
+#endif
+}
+
+static int _snz_bitScanForward(uint32_t x) {
+    int i = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        i++;
+    }
+    return i;
+}
+
+static int _snz_popCount32(uint32_t x) {
+    int count = 0;
+    for (; x; x &= x - 1) {
+        count++;
+    }
+    return count;
+}
+
+// file and line are the callers, so instrumented builds attribute the pushes correctly
+static void _snz_hashTableAlloc(_snz_HashTable* t, int64_t capacity, const char* file, int64_t line) {
+    (void)file, (void)line;
+    t->capacity = capacity;
+    t->ctrl = (int8_t*)_SNZ_ARENA_PUSH_AT(t->arena, capacity, file, line);
+    memset(t->ctrl, _SNZ_HASH_CTRL_EMPTY, capacity);
+    t->keys = (uint8_t*)_SNZ_ARENA_PUSH_AT(t->arena, capacity * t->keySize, file, line);
+    t->vals = t->valSize ? (uint8_t*)_SNZ_ARENA_PUSH_AT(t->arena, capacity * t->valSize, file, line) : NULL;
+    t->count = 0;
+    t->deletedCount = 0;
+}
+
+static _snz_HashTable _snz_hashTableInit(snz_Arena* arena, int64_t keySize, int64_t valSize, int64_t initialCapacity, const char* file, int64_t line) {
+    _snz_HashTable t = { .arena = arena, .keySize = keySize, .valSize = valSize };
+    if (initialCapacity > 0) {
+        int64_t cap = _SNZ_HASH_GROUP_SIZE;
+        while (cap * 7 / 8 < initialCapacity) {
+            cap *= 2;
+        }
+        _snz_hashTableAlloc(&t, cap, file, line);
+    }
+    return t;
+}
+
+// returns the slot with key in it, or -1
+static int64_t _snz_hashTableFind(const _snz_HashTable* t, const void* key, uint64_t hash) {
+    if (t->capacity == 0) {
+        return -1;
+    }
+    int8_t h2 = (int8_t)(hash & 0x7F);
+    int64_t groupMask = t->capacity / _SNZ_HASH_GROUP_SIZE - 1;
+    int64_t group = (hash >> 7) & groupMask;
+    for (int64_t probe = 0; probe <= groupMask; probe++) {
+        int64_t base = group * _SNZ_HASH_GROUP_SIZE;
+        uint32_t matches = _snz_hashGroupMatch(&t->ctrl[base], h2);
+        while (matches) {
+            int64_t slot = base + _snz_bitScanForward(matches);
+            if (memcmp(&t->keys[slot * t->keySize], key, t->keySize) == 0) {
+                return slot;
+            }
+            matches &= matches - 1;
+        }
+        if (_snz_hashGroupMatch(&t->ctrl[base], _SNZ_HASH_CTRL_EMPTY)) {
+            return -1;
+        }
+        group = (group + probe + 1) & groupMask;  // triangular, visits every group when the count is a power of 2
+    }
+    return -1;
+}
+
+static int64_t _snz_hashTableInsert(_snz_HashTable* t, const void* key, uint64_t hash, bool* outNew, const char* file, int64_t line);
+
+static void _snz_hashTableGrow(_snz_HashTable* t, const char* file, int64_t line) {
+    _snz_HashTable old = *t;
+    int64_t newCap = old.capacity ? old.capacity : _SNZ_HASH_GROUP_SIZE;
+    if ((old.count + 1) * 16 > newCap * 7) {  // only double when over half the max load is live keys, otherwise this just clears tombstones
+        newCap *= 2;
+    }
+    _snz_hashTableAlloc(t, newCap, file, line);
+    for (int64_t i = 0; i < old.capacity; i++) {
+        if (old.ctrl[i] < 0) {
+            continue;  // empty or deleted
+        }
+        const void* k = &old.keys[i * old.keySize];
+        bool isNew = false;
+        int64_t slot = _snz_hashTableInsert(t, k, _snz_hashBytes(k, old.keySize), &isNew, file, line);
+        if (old.valSize) {
+            memcpy(&t->vals[slot * t->valSize], &old.vals[i * old.valSize], old.valSize);
+        }
+    }
+}
+
+// returns the slot for key, adding it if it wasn't there. New slots have zeroed values.
+// file and line are the callers, any growth is attributed to them
+static int64_t _snz_hashTableInsert(_snz_HashTable* t, const void* key, uint64_t hash, bool* outNew, const char* file, int64_t line) {
+    int64_t found = _snz_hashTableFind(t, key, hash);
+    if (found >= 0) {
+        *outNew = false;
+        return found;
+    }
+    if ((t->count + t->deletedCount + 1) * 8 > t->capacity * 7) {
+        _snz_hashTableGrow(t, file, line);
+    }
+
+    int8_t h2 = (int8_t)(hash & 0x7F);
+    int64_t groupMask = t->capacity / _SNZ_HASH_GROUP_SIZE - 1;
+    int64_t group = (hash >> 7) & groupMask;
+    for (int64_t probe = 0; probe <= groupMask; probe++) {
+        int64_t base = group * _SNZ_HASH_GROUP_SIZE;
+        uint32_t open = _snz_hashGroupMatch(&t->ctrl[base], _SNZ_HASH_CTRL_EMPTY) |
+                        _snz_hashGroupMatch(&t->ctrl[base], _SNZ_HASH_CTRL_DELETED);
+        if (open) {
+            int64_t slot = base + _snz_bitScanForward(open);
+            if (t->ctrl[slot] == _SNZ_HASH_CTRL_DELETED) {
+                t->deletedCount--;
+            }
+            t->ctrl[slot] = h2;
+            memcpy(&t->keys[slot * t->keySize], key, t->keySize);
+            if (t->valSize) {
+                memset(&t->vals[slot * t->valSize], 0, t->valSize);
+            }
+            t->count++;
+            *outNew = true;
+            return slot;
+        }
+        group = (group + probe + 1) & groupMask;
+    }
+    SNZ_ASSERT(false, "hash table insert failed, no open slots (should be unreachable).");
+    return -1;
+}
+
+// returns whether the key was there to remove
+static bool _snz_hashTableRemove(_snz_HashTable* t, const void* key, uint64_t hash) {
+    int64_t slot = _snz_hashTableFind(t, key, hash);
+    if (slot < 0) {
+        return false;
+    }
+    t->ctrl[slot] = _SNZ_HASH_CTRL_DELETED;
+    t->count--;
+    t->deletedCount++;
+    return true;
+}
+
+// hash set of K, may be zero initialized as long as table.arena and table.keySize are set, prefer SNZ_HASH_SET_INIT
+// use SNZ_HASH_SET_INIT and SNZ_HASH_SET_INSERT so that growth is attributed to the caller
+#define SNZ_HASH_SET_NAMED(K, name)                                                                  \
+    typedef struct {                                                                                 \
+        _snz_HashTable table;                                                                        \
+    } name;                                                                                          \
+                                                                                                     \
+    static inline name name##_initAt(snz_Arena* arena, int64_t initialCapacity, const char* file, int64_t line) { \
+        return (name){ .table = _snz_hashTableInit(arena, sizeof(K), 0, initialCapacity, file, line) }; \
+    }                                                                                                \
+                                                                                                     \
+    /* returns true if key was newly added */                                                       \
+    static inline bool name##_insertAt(name* set, K key, const char* file, int64_t line) {           \
+        bool isNew = false;                                                                          \
+        _snz_hashTableInsert(&set->table, &key, _snz_hashBytes(&key, sizeof(K)), &isNew, file, line); \
+        return isNew;                                                                                \
+    }                                                                                                \
+                                                                                                     \
+    static inline bool name##_contains(const name* set, K key) {                                     \
+        return _snz_hashTableFind(&set->table, &key, _snz_hashBytes(&key, sizeof(K))) >= 0;          \
+    }                                                                                                \
+                                                                                                     \
+    static inline bool name##_remove(name* set, K key) {                                             \
+        return _snz_hashTableRemove(&set->table, &key, _snz_hashBytes(&key, sizeof(K)));             \
+    }                                                                                                \
+    static inline bool name##_remove(name* set, K key) /* redeclared so uses need a semicolon */
+
+#define SNZ_HASH_SET(K) SNZ_HASH_SET_NAMED(K, K##Set)
+
+// name is the set type name, set should be a ptr to one
+#define SNZ_HASH_SET_INIT(name, arena, initialCapacity) name##_initAt((arena), (initialCapacity), __FILE__, __LINE__)
+#define SNZ_HASH_SET_INSERT(name, set, key) name##_insertAt((set), (key), __FILE__, __LINE__)
+
+// hash map from K to V, see SNZ_HASH_SET_NAMED
+// value ptrs are invalidated by later inserts
+// use SNZ_HASH_MAP_INIT, SNZ_HASH_MAP_GET_OR_INSERT, and SNZ_HASH_MAP_SET so that growth is attributed to the caller
+#define SNZ_HASH_MAP_NAMED(K, V, name)                                                               \
+    typedef struct {                                                                                 \
+        _snz_HashTable table;                                                                        \
+    } name;                                                                                          \
+                                                                                                     \
+    static inline name name##_initAt(snz_Arena* arena, int64_t initialCapacity, const char* file, int64_t line) { \
+        return (name){ .table = _snz_hashTableInit(arena, sizeof(K), sizeof(V), initialCapacity, file, line) }; \
+    }                                                                                                \
+                                                                                                     \
+    /* returns NULL if key isn't in the map */                                                      \
+    static inline V* name##_get(const name* map, K key) {                                            \
+        int64_t slot = _snz_hashTableFind(&map->table, &key, _snz_hashBytes(&key, sizeof(K)));       \
+        return (slot < 0) ? NULL : &((V*)(map->table.vals))[slot];                                   \
+    }                                                                                                \
+                                                                                                     \
+    /* returns the value for key, zeroed if it wasn't in the map before. outNew may be NULL */      \
+    static inline V* name##_getOrInsertAt(name* map, K key, bool* outNew, const char* file, int64_t line) { \
+        bool isNew = false;                                                                          \
+        int64_t slot = _snz_hashTableInsert(&map->table, &key, _snz_hashBytes(&key, sizeof(K)), &isNew, file, line); \
+        if (outNew) {                                                                                \
+            *outNew = isNew;                                                                         \
+        }                                                                                            \
+        return &((V*)(map->table.vals))[slot];                                                       \
+    }                                                                                                \
+                                                                                                     \
+    static inline void name##_setAt(name* map, K key, V val, const char* file, int64_t line) {       \
+        *name##_getOrInsertAt(map, key, NULL, file, line) = val;                                     \
+    }                                                                                                \
+                                                                                                     \
+    static inline bool name##_remove(name* map, K key) {                                             \
+        return _snz_hashTableRemove(&map->table, &key, _snz_hashBytes(&key, sizeof(K)));             \
+    }                                                                                                \
+    static inline bool name##_remove(name* map, K key) /* redeclared so uses need a semicolon */
+
+#define SNZ_HASH_MAP(K, V) SNZ_HASH_MAP_NAMED(K, V, K##To##V##Map)
+
+// name is the map type name, map should be a ptr to one
+#define SNZ_HASH_MAP_INIT(name, arena, initialCapacity) name##_initAt((arena), (initialCapacity), __FILE__, __LINE__)
+#define SNZ_HASH_MAP_GET_OR_INSERT(name, map, key, outNew) name##_getOrInsertAt((map), (key), (outNew), __FILE__, __LINE__)
+#define SNZ_HASH_MAP_SET(name, map, key, val) name##_setAt((map), (key), (val), __FILE__, __LINE__)
+
+// CONTAINERS ==================================================================
+
+// ARENA TESTS =================================================================
+// timed comparisons against the old ways of doing things, results get printed with snz_testPrint
+
+static double _snz_testMsSince(uint64_t startTicks) {
+    return (double)(SDL_GetPerformanceCounter() - startTicks) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+// checks that pushes after a clear, pop, or restore are zeroed, and that the zeroing happens on push and not on clear.
+// also prints timings for many small frames against the old memset of the used bytes on clear
+void snz_arenaTests() {
+    snz_testPrintSection("Arena");
+
+    snz_Arena a = snz_arenaInit(64 * 1024 * 1024, "arena tests");
+
+    {
+        bool zeroed = true;
+        for (int i = 0; i < 3; i++) {
+            uint8_t* bytes = SNZ_ARENA_PUSH_ARR(&a, 1000, uint8_t);
+            for (int j = 0; j < 1000; j++) {
+                zeroed &= bytes[j] == 0;
+                bytes[j] = 0xFF;
+            }
+            if (i == 0) {
+                snz_arenaClear(&a);
+            } else if (i == 1) {
+                snz_arenaPop(&a, (char*)(a.end) - (char*)bytes);
+            }
+        }
+        snz_ArenaMark mark = snz_arenaMark(&a);
+        uint64_t* after = SNZ_ARENA_PUSH_ARR(&a, 100, uint64_t);
+        after[99] = UINT64_MAX;
+        snz_arenaRestore(mark);
+        after = SNZ_ARENA_PUSH_ARR(&a, 100, uint64_t);
+        zeroed &= after[99] == 0;
+        snz_testPrint(zeroed, "pushes after clear, pop, and restore are zeroed");
+        snz_arenaClear(&a);
+    }
+
+    {
+        uint8_t* bytes = SNZ_ARENA_PUSH_ARR(&a, 64, uint8_t);
+        memset(bytes, 0xFF, 64);
+        snz_arenaClear(&a);
+        bool dirtyAfterClear = bytes[0] == 0xFF && bytes[63] == 0xFF;
+        SNZ_ARENA_PUSH_ARR(&a, 32, uint8_t);
+        bool zeroedOnPush = bytes[0] == 0 && bytes[31] == 0 && bytes[32] == 0xFF;
+        snz_testPrint(dirtyAfterClear && zeroedOnPush, "memory is zeroed when pushed, not when cleared");
+        snz_arenaClear(&a);
+    }
+
+    {
+        const int frameCount = 50;
+        const int pushesPerFrame = 64;
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (int f = 0; f < frameCount; f++) {
+            for (int i = 0; i < pushesPerFrame; i++) {
+                uint8_t* bytes = SNZ_ARENA_PUSH_ARR(&a, 256, uint8_t);
+                bytes[0] = 1;
+            }
+            snz_arenaClear(&a);
+        }
+        double lazyMs = _snz_testMsSince(start);
+
+        start = SDL_GetPerformanceCounter();
+        for (int f = 0; f < frameCount; f++) {
+            for (int i = 0; i < pushesPerFrame; i++) {
+                uint8_t* bytes = SNZ_ARENA_PUSH_ARR(&a, 256, uint8_t);
+                bytes[0] = 1;
+            }
+            int64_t used = (char*)(a.end) - (char*)(a.start);
+            snz_arenaClear(&a);
+            memset(a.start, 0, used);  // what clearing used to do
+        }
+        double memsetMs = _snz_testMsSince(start);
+
+        // the lazy path zeroes the same bytes on the next push, so this is about where the cost lands, not a win to assert on
+        printf("lazy: %.3fms, memset on clear: %.3fms\n", lazyMs, memsetMs);
+    }
+
+    snz_arenaDeinit(&a);
+}
+
+SNZ_HASH_MAP_NAMED(uint64_t, uint64_t, _snz_TestMap);
+SNZ_DYNARR_NAMED(uint64_t, _snz_TestDynArr);
+
+// checks the map and dynamic array against a plain slice, and times lookups against the linear scans they replaced
+void snz_containerTests() {
+    snz_testPrintSection("Container");
+
+    snz_Arena a = snz_arenaInit(64 * 1024 * 1024, "container tests");
+    const int keyCount = 4000;
+
+    uint64_t* keys = SNZ_ARENA_PUSH_ARR(&a, keyCount, uint64_t);
+    for (int i = 0; i < keyCount; i++) {
+        keys[i] = snz_hashCombine(0, i);
+    }
+
+    _snz_TestMap map = SNZ_HASH_MAP_INIT(_snz_TestMap, &a, 0);
+    _snz_TestDynArr arr = SNZ_DYNARR_INIT(_snz_TestDynArr, &a, 0);
+    for (int i = 0; i < keyCount; i++) {
+        SNZ_HASH_MAP_SET(_snz_TestMap, &map, keys[i], i);
+        *SNZ_DYNARR_PUSH(_snz_TestDynArr, &arr) = keys[i];
+    }
+
+    {
+        bool correct = map.table.count == keyCount && arr.count == keyCount;
+        for (int i = 0; i < keyCount; i++) {
+            uint64_t* val = _snz_TestMap_get(&map, keys[i]);
+            correct &= val != NULL && *val == (uint64_t)i && arr.elems[i] == keys[i];
+        }
+        correct &= _snz_TestMap_get(&map, 0) == NULL;
+        for (int i = 0; i < keyCount; i += 2) {
+            correct &= _snz_TestMap_remove(&map, keys[i]);
+        }
+        for (int i = 0; i < keyCount; i++) {
+            correct &= (_snz_TestMap_get(&map, keys[i]) != NULL) == (i % 2 == 1);
+        }
+        snz_testPrint(correct, "map and dynamic array agree with a slice");
+        for (int i = 0; i < keyCount; i += 2) {
+            SNZ_HASH_MAP_SET(_snz_TestMap, &map, keys[i], i);
+        }
+    }
+
+    {
+        // volatile so the lookups can't be optimized out
+        volatile uint64_t found = 0;
+
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < keyCount; i++) {
+            found += _snz_TestMap_get(&map, keys[keyCount - 1 - i]) != NULL;
+        }
+        double mapMs = _snz_testMsSince(start);
+
+        start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < keyCount; i++) {
+            for (int j = 0; j < arr.count; j++) {
+                if (arr.elems[j] == keys[keyCount - 1 - i]) {
+                    found++;
+                    break;
+                }
+            }
+        }
+        double scanMs = _snz_testMsSince(start);
+
+        printf("map: %.3fms, linear scan: %.3fms\n", mapMs, scanMs);
+        snz_testPrint(found == 2 * (uint64_t)keyCount, "map and linear scan find every key");
+        snz_testPrint(mapMs < scanMs, "map lookups are faster than a linear scan");
+    }
+
+    snz_arenaDeinit(&a);
+}
+
+// ARENA TESTS =================================================================
+
 // ARENAS ======================================================================
 // ARENAS ======================================================================
 // ARENAS ======================================================================
@@ -212,28 +1075,56 @@ void _snz_arenaArrEnd(snz_Arena* a, int64_t elemSize) {
 // RENDER ======================================================================
 // RENDER ======================================================================
 
-#define _SNZR_FONT_ATLAS_W 2000
-#define _SNZR_FONT_ATLAS_H 2000
-
 typedef struct {
     uint32_t glId;
     uint32_t width;
     uint32_t height;
 } snzr_Texture;  // doesn't own or point pixel memory, assumed to be loaded on the gpu already
 
+// offsets and advance are in pixels at the fonts rendered size
+typedef struct {
+    int glyphIdx;  // in the font file
+    float xoff, yoff, xoff2, yoff2;  // bitmap box relative to the pen
+    float xadvance;
+    uint16_t x0, y0, x1, y1;  // location in the atlas, all 0 until rasterized or if there is nothing to draw
+    bool rasterized;
+} _snzr_Glyph;
+
+SNZ_HASH_MAP_NAMED(uint32_t, _snzr_Glyph, _snzr_GlyphMap);
+
+// glyphs get measured the first time a codepoint is seen, and rasterized into the atlas the first time it's drawn
+// atlas is packed in shelves, left to right and then top to bottom
+typedef struct {
+    stbtt_fontinfo info;
+    float scale;
+    int unknownGlyphIdx;
+
+    _snzr_Glyph ascii[128];  // always measured
+    _snzr_GlyphMap others;
+
+    uint32_t shelfX;
+    uint32_t shelfY;
+    uint32_t shelfHeight;
+    bool full;
+
+    bool sdf;  // atlas holds distance fields instead of coverage, see snzr_fontInitSDF
+} _snzr_GlyphCache;
+
 typedef struct {
     float renderedSize;
     float ascent;
     float descent;  // FIXME: what sign is this
     float lineGap;
-    stbtt_pack_range packRange;
     snzr_Texture atlas;
+    float* advances;  // 128, indexed by ascii byte. Chars that snzr_strSize skips have 0
+    _snzr_GlyphCache* glyphs;  // shared between copies of the font
 } snzr_Font;
 
 struct {
     HMM_Vec2 screenSize;
 
-    uint32_t rectShaderId;
+    uint32_t rectBatchVAO;
+    uint32_t rectBatchVBO;
     uint32_t lineShaderId;
     uint32_t lineShaderSSBOId;
 
@@ -259,6 +1150,110 @@ static void _snzr_glDebugCallback(GLenum source, GLenum type, GLuint id, GLenum
         }                                                                                   \
     } while (0)
 
+// GL STATE CACHE ==============================================================
+// snooze routes program, texture and buffer binds through here so that binds of whatever is already bound
+// get skipped. Anything outside of snooze that binds gl state directly should call snzr_glStateInvalidate after.
+
+#define _SNZR_TEXTURE_UNIT_COUNT 2
+
+// all counts are for one frame, see snzr_getFrameStats
+typedef struct {
+    uint64_t drawCalls;
+    uint64_t stateChanges;  // program, texture, buffer and uniform changes that actually reached gl
+    uint64_t instances;  // rects and glyphs drawn through batches
+    uint64_t glyphs;
+} snzr_FrameStats;
+
+struct {
+    uint32_t program;
+    uint32_t activeTextureUnit;
+    uint32_t textures[_SNZR_TEXTURE_UNIT_COUNT];
+    uint32_t vertexArray;
+    uint32_t arrayBuffer;
+    bool valid;  // when false nothing above is trusted, and the next bind of each always goes through
+
+    snzr_FrameStats frameStats;
+    snzr_FrameStats lastFrameStats;
+} _snzr_glState;
+
+// forgets everything cached, so the next bind of each kind reaches gl
+void snzr_glStateInvalidate() {
+    _snzr_glState.valid = false;
+}
+
+// counts for the last finished frame, snz_main rolls these over
+snzr_FrameStats snzr_getFrameStats() {
+    return _snzr_glState.lastFrameStats;
+}
+
+static void _snzr_frameStatsRollOver() {
+    _snzr_glState.lastFrameStats = _snzr_glState.frameStats;
+    _snzr_glState.frameStats = (snzr_FrameStats){ 0 };
+}
+
+static void _snzr_glStateValidate() {
+    if (_snzr_glState.valid) {
+        return;
+    }
+    // ids gl never hands out, so every first bind after this mismatches
+    _snzr_glState.program = UINT32_MAX;
+    _snzr_glState.activeTextureUnit = UINT32_MAX;
+    for (int i = 0; i < _SNZR_TEXTURE_UNIT_COUNT; i++) {
+        _snzr_glState.textures[i] = UINT32_MAX;
+    }
+    _snzr_glState.vertexArray = UINT32_MAX;
+    _snzr_glState.arrayBuffer = UINT32_MAX;
+    _snzr_glState.valid = true;
+}
+
+static void _snzr_useProgram(uint32_t id) {
+    _snzr_glStateValidate();
+    if (_snzr_glState.program == id) {
+        return;
+    }
+    snzr_callGLFnOrError(glUseProgram(id));
+    _snzr_glState.program = id;
+    _snzr_glState.frameStats.stateChanges++;
+}
+
+// binds to GL_TEXTURE_2D on unit
+static void _snzr_bindTexture(uint32_t unit, uint32_t id) {
+    SNZ_ASSERTF(unit < _SNZR_TEXTURE_UNIT_COUNT, "texture unit %u isn't tracked.", unit);
+    _snzr_glStateValidate();
+    if (_snzr_glState.textures[unit] == id) {
+        return;
+    }
+    if (_snzr_glState.activeTextureUnit != unit) {
+        snzr_callGLFnOrError(glActiveTexture(GL_TEXTURE0 + unit));
+        _snzr_glState.activeTextureUnit = unit;
+    }
+    snzr_callGLFnOrError(glBindTexture(GL_TEXTURE_2D, id));
+    _snzr_glState.textures[unit] = id;
+    _snzr_glState.frameStats.stateChanges++;
+}
+
+static void _snzr_bindVertexArray(uint32_t id) {
+    _snzr_glStateValidate();
+    if (_snzr_glState.vertexArray == id) {
+        return;
+    }
+    snzr_callGLFnOrError(glBindVertexArray(id));
+    _snzr_glState.vertexArray = id;
+    _snzr_glState.frameStats.stateChanges++;
+}
+
+static void _snzr_bindArrayBuffer(uint32_t id) {
+    _snzr_glStateValidate();
+    if (_snzr_glState.arrayBuffer == id) {
+        return;
+    }
+    snzr_callGLFnOrError(glBindBuffer(GL_ARRAY_BUFFER, id));
+    _snzr_glState.arrayBuffer = id;
+    _snzr_glState.frameStats.stateChanges++;
+}
+
+// GL STATE CACHE ==============================================================
+
 // step kind should be GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
 // asserts on failure of any kind, including opening the file and compiling the shader stage
 static uint32_t _snzr_loadShaderStep(const char* src, GLenum stepKind, snz_Arena* scratch) {
@@ -297,7 +1292,7 @@ uint32_t snzr_shaderInit(const char* vertChars, const char* fragChars, snz_Arena
 snzr_Texture snzr_textureInitRBGA(int32_t width, int32_t height, uint8_t* data) {
     snzr_Texture out = { .width = width, .height = height };
     snzr_callGLFnOrError(glGenTextures(1, &out.glId));
-    snzr_callGLFnOrError(glBindTexture(GL_TEXTURE_2D, out.glId));
+    _snzr_bindTexture(0, out.glId);
     snzr_callGLFnOrError(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
     snzr_callGLFnOrError(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
     snzr_callGLFnOrError(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
@@ -310,7 +1305,7 @@ snzr_Texture snzr_textureInitRBGA(int32_t width, int32_t height, uint8_t* data)
 snzr_Texture snzr_textureInitGrayscale(int32_t width, int32_t height, uint8_t* data) {
     snzr_Texture out = { .width = width, .height = height };
     snzr_callGLFnOrError(glGenTextures(1, &out.glId));
-    snzr_callGLFnOrError(glBindTexture(GL_TEXTURE_2D, out.glId));
+    _snzr_bindTexture(0, out.glId);
     snzr_callGLFnOrError(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
     snzr_callGLFnOrError(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
     snzr_callGLFnOrError(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
@@ -337,8 +1332,7 @@ snzr_FrameBuffer snzr_frameBufferInit(snzr_Texture tex) {
     snzr_callGLFnOrError(glGenFramebuffers(1, &out.glId));
     snzr_callGLFnOrError(glBindFramebuffer(GL_FRAMEBUFFER, out.glId));
 
-    snzr_callGLFnOrError(glActiveTexture(GL_TEXTURE0));
-    snzr_callGLFnOrError(glBindTexture(GL_TEXTURE_2D, tex.glId));
+    _snzr_bindTexture(0, tex.glId);
     snzr_callGLFnOrError(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex.glId, 0));
 
     snzr_callGLFnOrError(glGenRenderbuffers(1, &out.depthBufferId));
@@ -356,13 +1350,148 @@ void snzr_frameBufferDeinit(snzr_FrameBuffer* fb) {
     glDeleteRenderbuffers(1, &fb->depthBufferId);
     glDeleteTextures(1, &fb->texture.glId);
     memset(fb, 0, sizeof(*fb));
+    snzr_glStateInvalidate();  // the ids can get handed out again, which would fool the cache
 }
 
-#define _SNZR_FONT_FIRST_ASCII 32
-#define _SNZR_FONT_ASCII_CHAR_COUNT (255 - _SNZR_FONT_FIRST_ASCII)
 #define _SNZR_FONT_UNKNOWN_CHAR 9633  // white box, see: https://www.fileformat.info/info/unicode/char/25a1/index.htm
+#define _SNZR_FONT_REPLACEMENT_CHAR 0xFFFD
+
+// sdf glyphs get this many pixels of falloff around them, and the edge sits at the middle of the 0-255 range
+#define _SNZR_FONT_SDF_PADDING 4
+#define _SNZR_FONT_SDF_ON_EDGE 128
+
+// decodes the codepoint at the start of str, outByteCount is set to how many bytes it used
+// malformed sequences decode to U+FFFD one byte at a time, so bad input never gets skipped over entirely
+static uint32_t _snzr_utf8Decode(const uint8_t* str, uint64_t remaining, uint64_t* outByteCount) {
+    uint8_t lead = str[0];
+    uint64_t len = 0;
+    uint32_t cp = 0;
+    uint32_t min = 0;
+    if (lead < 0x80) {
+        *outByteCount = 1;
+        return lead;
+    } else if (lead >= 0xC2 && lead <= 0xDF) {
+        len = 2;
+        cp = lead & 0x1F;
+        min = 0x80;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        len = 3;
+        cp = lead & 0x0F;
+        min = 0x800;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        len = 4;
+        cp = lead & 0x07;
+        min = 0x10000;
+    }
 
-snzr_Font snzr_fontInit(snz_Arena* dataArena, snz_Arena* scratch, const char* path, float size) {
+    *outByteCount = 1;
+    if (len == 0 || len > remaining) {
+        return _SNZR_FONT_REPLACEMENT_CHAR;
+    }
+    for (uint64_t i = 1; i < len; i++) {
+        if ((str[i] & 0xC0) != 0x80) {
+            return _SNZR_FONT_REPLACEMENT_CHAR;
+        }
+        cp = (cp << 6) | (str[i] & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        return _SNZR_FONT_REPLACEMENT_CHAR;
+    }
+    *outByteCount = len;
+    return cp;
+}
+
+static void _snzr_glyphMeasure(const _snzr_GlyphCache* c, _snzr_Glyph* g, uint32_t codepoint) {
+    int idx = 0;
+    if (codepoint >= 32) {  // control chars get the unknown box, same as chars the font is missing
+        idx = stbtt_FindGlyphIndex(&c->info, codepoint);
+    }
+    if (idx == 0) {
+        idx = c->unknownGlyphIdx;
+    }
+
+    int advance, leftSideBearing, x0, y0, x1, y1;
+    stbtt_GetGlyphHMetrics(&c->info, idx, &advance, &leftSideBearing);
+    stbtt_GetGlyphBitmapBox(&c->info, idx, c->scale, c->scale, &x0, &y0, &x1, &y1);
+    if (c->sdf && x0 != x1 && y0 != y1) {  // matches the box stbtt_GetGlyphSDF makes
+        x0 -= _SNZR_FONT_SDF_PADDING;
+        y0 -= _SNZR_FONT_SDF_PADDING;
+        x1 += _SNZR_FONT_SDF_PADDING;
+        y1 += _SNZR_FONT_SDF_PADDING;
+    }
+    *g = (_snzr_Glyph){
+        .glyphIdx = idx,
+        .xoff = x0,
+        .yoff = y0,
+        .xoff2 = x1,
+        .yoff2 = y1,
+        .xadvance = advance * c->scale,
+    };
+}
+
+// measured but possibly not rasterized, ptr is only valid until the next lookup
+static _snzr_Glyph* _snzr_glyphGet(_snzr_GlyphCache* c, uint32_t codepoint) {
+    if (codepoint < 128) {
+        return &c->ascii[codepoint];
+    }
+    bool isNew = false;
+    _snzr_Glyph* g = SNZ_HASH_MAP_GET_OR_INSERT(_snzr_GlyphMap, &c->others, codepoint, &isNew);
+    if (isNew) {
+        _snzr_glyphMeasure(c, g, codepoint);
+    }
+    return g;
+}
+
+// finds room in the atlas and uploads the glyphs bitmap there
+// when the atlas is full the glyph is left empty and draws as nothing
+static void _snzr_glyphRasterize(_snzr_GlyphCache* c, snzr_Texture atlas, _snzr_Glyph* g) {
+    g->rasterized = true;
+    uint32_t w = g->xoff2 - g->xoff;
+    uint32_t h = g->yoff2 - g->yoff;
+    if (w == 0 || h == 0 || c->full) {
+        return;
+    }
+
+    // one pixel of padding right and below so filtering doesn't pull in the neighbors
+    if (c->shelfX + w + 1 > atlas.width) {
+        c->shelfX = 0;
+        c->shelfY += c->shelfHeight + 1;
+        c->shelfHeight = 0;
+    }
+    if (c->shelfY + h + 1 > atlas.height) {
+        printf("[snzr]: font atlas is full, glyph %d won't be drawn.\n", g->glyphIdx);
+        c->full = true;
+        return;
+    }
+
+    int bitmapW = 0, bitmapH = 0;
+    uint8_t* bitmap = NULL;
+    if (c->sdf) {
+        float pixelDistScale = (float)_SNZR_FONT_SDF_ON_EDGE / _SNZR_FONT_SDF_PADDING;
+        bitmap = stbtt_GetGlyphSDF(&c->info, c->scale, g->glyphIdx,
+                                   _SNZR_FONT_SDF_PADDING, _SNZR_FONT_SDF_ON_EDGE, pixelDistScale,
+                                   &bitmapW, &bitmapH, NULL, NULL);
+    } else {
+        bitmap = stbtt_GetGlyphBitmap(&c->info, c->scale, c->scale, g->glyphIdx, &bitmapW, &bitmapH, NULL, NULL);
+    }
+    SNZ_ASSERT((uint32_t)bitmapW == w && (uint32_t)bitmapH == h, "glyph bitmap didn't match its measured box.");
+    _snzr_bindTexture(0, atlas.glId);
+    snzr_callGLFnOrError(glTexSubImage2D(GL_TEXTURE_2D, 0, c->shelfX, c->shelfY, w, h, GL_RED, GL_UNSIGNED_BYTE, bitmap));
+    if (c->sdf) {
+        stbtt_FreeSDF(bitmap, NULL);
+    } else {
+        stbtt_FreeBitmap(bitmap, NULL);
+    }
+
+    g->x0 = c->shelfX;
+    g->y0 = c->shelfY;
+    g->x1 = c->shelfX + w;
+    g->y1 = c->shelfY + h;
+    c->shelfX += w + 1;
+    c->shelfHeight = SNZ_MAX(c->shelfHeight, h);
+}
+
+static snzr_Font _snzr_fontInit(snz_Arena* dataArena, snz_Arena* scratch, const char* path, float size, bool sdf) {
     snzr_Font out = { .renderedSize = size };
 
     uint8_t* fileData;
@@ -374,83 +1503,186 @@ snzr_Font snzr_fontInit(snz_Arena* dataArena, snz_Arena* scratch, const char* pa
         uint64_t size = ftell(file);
         fseek(file, 0L, SEEK_SET);
 
-        fileData = SNZ_ARENA_PUSH_ARR(scratch, size, uint8_t);
+        fileData = SNZ_ARENA_PUSH_ARR(dataArena, size, uint8_t);
         SNZ_ASSERT(fread(fileData, sizeof(uint8_t), size, file) == size, "reading font file failed.");
         fclose(file);
     }
 
-    stbtt_fontinfo font;
-    stbtt_InitFont(&font, fileData, stbtt_GetFontOffsetForIndex(fileData, 0));
+    _snzr_GlyphCache* c = SNZ_ARENA_PUSH(dataArena, _snzr_GlyphCache);
+    out.glyphs = c;
+    c->sdf = sdf;
+    SNZ_ASSERT(stbtt_InitFont(&c->info, fileData, stbtt_GetFontOffsetForIndex(fileData, 0)), "parsing font file failed.");
+    c->scale = stbtt_ScaleForPixelHeight(&c->info, out.renderedSize);
+    c->unknownGlyphIdx = stbtt_FindGlyphIndex(&c->info, _SNZR_FONT_UNKNOWN_CHAR);  // 0 if missing, which is the fonts own missing glyph
+    c->others = SNZ_HASH_MAP_INIT(_snzr_GlyphMap, dataArena, 64);
     stbtt_GetScaledFontVMetrics(fileData, 0, out.renderedSize,
                                 &out.ascent,
                                 &out.descent,
                                 &out.lineGap);
 
-    stbtt_pack_context ctx;
-    uint8_t* atlasData = SNZ_ARENA_PUSH_ARR(scratch, _SNZR_FONT_ATLAS_W * _SNZR_FONT_ATLAS_H, uint8_t);
-    assert(stbtt_PackBegin(&ctx, atlasData,
-        _SNZR_FONT_ATLAS_W,
-        _SNZR_FONT_ATLAS_H,
-        _SNZR_FONT_ATLAS_W,
-        1,
-        NULL));
-    stbtt_PackSetOversampling(&ctx, 1, 1);
-
-    const int glyphCount = _SNZR_FONT_ASCII_CHAR_COUNT + 1;
-    int codepoints[glyphCount];
-    codepoints[0] = _SNZR_FONT_UNKNOWN_CHAR;
-    for (int i = 0; i < _SNZR_FONT_ASCII_CHAR_COUNT; i++) {
-        // skip 0, thats the missing glyph
-        codepoints[i + 1] = _SNZR_FONT_FIRST_ASCII + i;
-    }
-
-    out.packRange = (stbtt_pack_range){
-        .font_size = out.renderedSize,
-        .array_of_unicode_codepoints = codepoints,
-        .num_chars = glyphCount,
-        .chardata_for_range = SNZ_ARENA_PUSH_ARR(dataArena, glyphCount, stbtt_packedchar),
-    };
-    stbtt_PackFontRanges(&ctx, fileData, 0, &out.packRange, 1);
-    stbtt_PackEnd(&ctx);
+    out.advances = SNZ_ARENA_PUSH_ARR(dataArena, 128, float);
+    for (uint32_t i = 0; i < 128; i++) {
+        _snzr_glyphMeasure(c, &c->ascii[i], i);
+        if (i == '\n' || i == '\r' || i == '\t') {
+            continue;
+        }
+        out.advances[i] = c->ascii[i].xadvance;
+    }
 
-    out.atlas = snzr_textureInitGrayscale(_SNZR_FONT_ATLAS_W, _SNZR_FONT_ATLAS_H, atlasData);
+    // room for several hundred glyphs at this size, which covers any roster we've seen
+    float glyphSize = size + (sdf ? 2 * _SNZR_FONT_SDF_PADDING : 0);
+    uint32_t atlasSize = 256;
+    while (atlasSize < glyphSize * 22) {
+        atlasSize *= 2;
+    }
+    uint8_t* atlasData = SNZ_ARENA_PUSH_ARR(scratch, atlasSize * atlasSize, uint8_t);  // zeroed
+    out.atlas = snzr_textureInitGrayscale(atlasSize, atlasSize, atlasData);
     return out;
 }
 
+// the font file is kept in dataArena, because glyphs are rasterized from it as they get used
+// text looks best drawn at size, see snzr_fontInitSDF for text that gets drawn at lots of sizes
+snzr_Font snzr_fontInit(snz_Arena* dataArena, snz_Arena* scratch, const char* path, float size) {
+    return _snzr_fontInit(dataArena, scratch, path, size, false);
+}
+
+// glyphs are stored as signed distance fields, so they stay sharp when drawn at any height with
+// snzr_drawTextScaled (or snzu_boxSetDisplayStrMode) from just this one atlas.
+// size is what they get rasterized at, 32 or so holds up well for anything from small labels to headers
+snzr_Font snzr_fontInitSDF(snz_Arena* dataArena, snz_Arena* scratch, const char* path, float size) {
+    return _snzr_fontInit(dataArena, scratch, path, size, true);
+}
+
+// RECT BATCHING ===============================================================
+// snzr_drawRect and snzr_drawTextScaled don't draw right away, they append instances here, and consecutive
+// rects and glyphs that can share textures and a vp get drawn with one instanced call when the batch is flushed.
+// anything that draws some other way has to call snzr_flush first so that order is kept
+//
+// the rect shader is compiled once per combination of the _SNZR_RECT_FEATURE_* flags, and each batch draws with
+// the variant for the features its instances used. So a batch of plain boxes skips the textures and the rounded
+// rect math entirely, while a mixed batch still draws in one call.
+
+#define _SNZR_RECT_BATCH_CAPACITY 4096
+
+// what the rect shader does with an instance, see _snzr_RectInstance.kind
+#define _SNZR_INSTANCE_KIND_RECT 0
+#define _SNZR_INSTANCE_KIND_GLYPH 1
+#define _SNZR_INSTANCE_KIND_SDF_GLYPH 2
+
+#define _SNZR_RECT_FEATURE_RECT (1 << 0)
+#define _SNZR_RECT_FEATURE_ROUNDED (1 << 1)  // corner radius or border
+#define _SNZR_RECT_FEATURE_TEXTURED (1 << 2)  // color texture that isn't solidTex
+#define _SNZR_RECT_FEATURE_GLYPH (1 << 3)
+#define _SNZR_RECT_FEATURE_SDF_GLYPH (1 << 4)
+#define _SNZR_RECT_FEATURE_COMBO_COUNT (1 << 5)
+
+// matches the per instance attributes in the rect shader, locations are in field order
+typedef struct {
+    HMM_Vec2 dstStart;
+    HMM_Vec2 dstEnd;
+    HMM_Vec2 srcStart;
+    HMM_Vec2 srcEnd;
+    HMM_Vec2 clipStart;
+    HMM_Vec2 clipEnd;
+    HMM_Vec4 color;
+    HMM_Vec4 borderColor;
+    float cornerRadius;
+    float borderThickness;
+    float kind;  // _SNZR_INSTANCE_KIND_*, rects may sample the color texture and glyphs the font texture
+    float sampleColorTex;  // 1 for rects with a texture, solid rects can share a textured batch without being tinted by it
+} _snzr_RectInstance;
+
 struct {
-    int vp;
-    int z;
-    int cornerRadius;
-    int borderThickness;
-    int borderColor;
-    int dstStart;
-    int dstEnd;
-    int srcStart;
-    int srcEnd;
-    int clipStart;
-    int clipEnd;
-    int color;
-    int fontTexture;
-    int colorTexture;
-} _snzr_rectShaderLocations;
-
-static void _snzr_rectShaderLocationsInit(uint32_t id) {
-    _snzr_rectShaderLocations.vp = glGetUniformLocation(id, "uVP");
-    _snzr_rectShaderLocations.z = glGetUniformLocation(id, "uZ");
-    _snzr_rectShaderLocations.cornerRadius = glGetUniformLocation(id, "uCornerRadius");
-    _snzr_rectShaderLocations.borderThickness = glGetUniformLocation(id, "uBorderThickness");
-    _snzr_rectShaderLocations.borderColor = glGetUniformLocation(id, "uBorderColor");
-    _snzr_rectShaderLocations.dstStart = glGetUniformLocation(id, "uDstStart");
-    _snzr_rectShaderLocations.dstEnd = glGetUniformLocation(id, "uDstEnd");
-    _snzr_rectShaderLocations.srcStart = glGetUniformLocation(id, "uSrcStart");
-    _snzr_rectShaderLocations.srcEnd = glGetUniformLocation(id, "uSrcEnd");
-    _snzr_rectShaderLocations.clipStart = glGetUniformLocation(id, "uClipStart");
-    _snzr_rectShaderLocations.clipEnd = glGetUniformLocation(id, "uClipEnd");
-    _snzr_rectShaderLocations.color = glGetUniformLocation(id, "uColor");
-    _snzr_rectShaderLocations.fontTexture = glGetUniformLocation(id, "uFontTexture");
-    _snzr_rectShaderLocations.colorTexture = glGetUniformLocation(id, "uColorTexture");
+    _snzr_RectInstance instances[_SNZR_RECT_BATCH_CAPACITY];
+    uint64_t count;
+
+    // state shared by everything in the batch, only valid when count > 0
+    // a tex id of 0 means nothing in the batch has sampled it yet
+    // rects only care about the color tex and glyphs only about the font tex, so they batch together
+    uint32_t fontTexId;
+    uint32_t colorTexId;
+    HMM_Mat4 vp;
+    uint32_t features;  // _SNZR_RECT_FEATURE_* flags of everything in the batch
+} _snzr_rectBatch;
+
+typedef struct {
+    uint32_t programId;  // 0 for combos that can't come out of a batch
+    int vpLoc;
+    HMM_Mat4 vp;  // last one uploaded, so batches with the same one skip the upload
+    bool vpUploaded;
+} _snzr_RectShaderVariant;
+
+_snzr_RectShaderVariant _snzr_rectShaderVariants[_SNZR_RECT_FEATURE_COMBO_COUNT];
+
+// draws and empties the current batch, does nothing when it is empty
+void snzr_flush() {
+    if (_snzr_rectBatch.count == 0) {
+        return;
+    }
+
+    uint32_t features = _snzr_rectBatch.features;
+    _snzr_RectShaderVariant* variant = &_snzr_rectShaderVariants[features];
+    SNZ_ASSERTF(variant->programId != 0, "no rect shader variant for features %u.", features);
+    _snzr_useProgram(variant->programId);
+    if (!variant->vpUploaded || memcmp(&variant->vp, &_snzr_rectBatch.vp, sizeof(HMM_Mat4)) != 0) {
+        glUniformMatrix4fv(variant->vpLoc, 1, false, (float*)&_snzr_rectBatch.vp);
+        variant->vp = _snzr_rectBatch.vp;
+        variant->vpUploaded = true;
+        _snzr_glState.frameStats.stateChanges++;
+    }
+
+    // only bind what the variant samples, sampler units were set when the variant was built
+    if (features & (_SNZR_RECT_FEATURE_GLYPH | _SNZR_RECT_FEATURE_SDF_GLYPH)) {
+        _snzr_bindTexture(0, _snzr_rectBatch.fontTexId);
+    }
+    if (features & _SNZR_RECT_FEATURE_TEXTURED) {
+        _snzr_bindTexture(1, _snzr_rectBatch.colorTexId);
+    }
+
+    _snzr_bindVertexArray(_snzr_globs.rectBatchVAO);
+    _snzr_bindArrayBuffer(_snzr_globs.rectBatchVBO);
+    // orphan the old storage so that the driver can hand out new memory instead of waiting on draws that still read it
+    snzr_callGLFnOrError(glBufferData(GL_ARRAY_BUFFER, sizeof(_snzr_rectBatch.instances), NULL, GL_STREAM_DRAW));
+    snzr_callGLFnOrError(glBufferSubData(GL_ARRAY_BUFFER, 0, _snzr_rectBatch.count * sizeof(_snzr_RectInstance), _snzr_rectBatch.instances));
+    snzr_callGLFnOrError(glDrawArraysInstanced(GL_TRIANGLES, 0, 6, _snzr_rectBatch.count));
+    _snzr_glState.frameStats.drawCalls++;
+    _snzr_glState.frameStats.instances += _snzr_rectBatch.count;
+
+    _snzr_rectBatch.count = 0;
+    _snzr_rectBatch.fontTexId = 0;
+    _snzr_rectBatch.colorTexId = 0;
+    _snzr_rectBatch.features = 0;
 }
 
+// returns a slot in the batch, flushing first if the state doesn't match or the batch is full
+// either tex id may be 0 if the instance doesn't sample it, features are the _SNZR_RECT_FEATURE_* flags it needs
+// contents of the returned instance are garbage, every field should be written
+static _snzr_RectInstance* _snzr_rectBatchPush(uint32_t fontTexId, uint32_t colorTexId, const HMM_Mat4* vp, uint32_t features) {
+    bool fontClash = fontTexId && _snzr_rectBatch.fontTexId && fontTexId != _snzr_rectBatch.fontTexId;
+    bool colorClash = colorTexId && _snzr_rectBatch.colorTexId && colorTexId != _snzr_rectBatch.colorTexId;
+    bool stateChanged = fontClash || colorClash || memcmp(&_snzr_rectBatch.vp, vp, sizeof(*vp)) != 0;
+    if (_snzr_rectBatch.count == _SNZR_RECT_BATCH_CAPACITY || (_snzr_rectBatch.count > 0 && stateChanged)) {
+        snzr_flush();
+    }
+    if (fontTexId) {
+        _snzr_rectBatch.fontTexId = fontTexId;
+    }
+    if (colorTexId) {
+        _snzr_rectBatch.colorTexId = colorTexId;
+    }
+    _snzr_rectBatch.vp = *vp;
+    _snzr_rectBatch.features |= features;
+    return &_snzr_rectBatch.instances[_snzr_rectBatch.count++];
+}
+
+static void _snzr_rectBatchAttribInit(uint32_t location, int32_t floatCount, uint64_t offset) {
+    snzr_callGLFnOrError(glEnableVertexAttribArray(location));
+    snzr_callGLFnOrError(glVertexAttribPointer(location, floatCount, GL_FLOAT, GL_FALSE, sizeof(_snzr_RectInstance), (void*)offset));
+    snzr_callGLFnOrError(glVertexAttribDivisor(location, 1));
+}
+
+// RECT BATCHING ===============================================================
+
 static void _snzr_init(snz_Arena* scratchArena) {
     {  // initialize gl settings
         gladLoadGL();
@@ -471,22 +1703,34 @@ static void _snzr_init(snz_Arena* scratchArena) {
         snzr_callGLFnOrError(glPixelStorei(GL_PACK_ALIGNMENT, 1));
     }
 
-    {
+    {  // everything per rect comes in as an instanced attribute
         const char* vertSrc =
             "#version 330 core\n"
+            "layout(location = 0) in vec2 iDstStart;"
+            "layout(location = 1) in vec2 iDstEnd;"
+            "layout(location = 2) in vec2 iSrcStart;"
+            "layout(location = 3) in vec2 iSrcEnd;"
+            "layout(location = 4) in vec2 iClipStart;"
+            "layout(location = 5) in vec2 iClipEnd;"
+            "layout(location = 6) in vec4 iColor;"
+            "layout(location = 7) in vec4 iBorderColor;"
+            "layout(location = 8) in float iCornerRadius;"
+            "layout(location = 9) in float iBorderThickness;"
+            "layout(location = 10) in float iKind;"
+            "layout(location = 11) in float iSampleColorTex;"
+            ""
             "out vec2 vUv;"
             "out vec2 vCenterFromFragPos;"
             "out vec2 vRectHalfSize;"
+            "flat out vec4 vColor;"
+            "flat out vec4 vBorderColor;"
+            "flat out float vCornerRadius;"
+            "flat out float vBorderThickness;"
+            "flat out float vKind;"
+            "flat out float vSampleColorTex;"
             ""
             "uniform mat4 uVP;"
             "uniform float uZ;"
-            "uniform vec2 uDstStart;"
-            "uniform vec2 uDstEnd;"
-            "uniform vec2 uSrcStart;"
-            "uniform vec2 uSrcEnd;"
-            ""
-            "uniform vec2 uClipStart;"
-            "uniform vec2 uClipEnd;"
             ""
             "vec2 cornerTable[6] = vec2[]("
             "    vec2(0, 0),"
@@ -499,43 +1743,55 @@ static void _snzr_init(snz_Arena* scratchArena) {
             ""
             "void main() {"
             "    vec2 uvPos = cornerTable[gl_VertexID % 6];"
-            "    uvPos *= uSrcEnd - uSrcStart;"
-            "    uvPos += uSrcStart;"
+            "    uvPos *= iSrcEnd - iSrcStart;"
+            "    uvPos += iSrcStart;"
             "    vUv = uvPos;"
             ""
             "    vec2 pos = cornerTable[gl_VertexID % 6];"
-            "    pos *= uDstEnd - uDstStart;"
-            "    pos += uDstStart;"
+            "    pos *= iDstEnd - iDstStart;"
+            "    pos += iDstStart;"
             ""
-            "    vec2 startDiff = uClipStart - pos;"
+            "    vec2 startDiff = iClipStart - pos;"
             "    startDiff = max(startDiff, vec2(0, 0));"
-            "    vec2 endDiff = uClipEnd - pos;"
+            "    vec2 endDiff = iClipEnd - pos;"
             "    endDiff = min(endDiff, vec2(0, 0));"
             ""
             "    vec2 totalDiff = startDiff + endDiff;"
-            "    vUv += totalDiff / (uDstEnd - uDstStart) * (uSrcEnd - uSrcStart);"
+            "    vUv += totalDiff / (iDstEnd - iDstStart) * (iSrcEnd - iSrcStart);"
             "    pos += totalDiff;"
             ""
-            "    vRectHalfSize = (uDstEnd - uDstStart) / 2.0;"
-            "    vCenterFromFragPos = (uDstStart + vRectHalfSize) - pos;"
+            "    vRectHalfSize = (iDstEnd - iDstStart) / 2.0;"
+            "    vCenterFromFragPos = (iDstStart + vRectHalfSize) - pos;"
+            "    vColor = iColor;"
+            "    vBorderColor = iBorderColor;"
+            "    vCornerRadius = iCornerRadius;"
+            "    vBorderThickness = iBorderThickness;"
+            "    vKind = iKind;"
+            "    vSampleColorTex = iSampleColorTex;"
             "    gl_Position = uVP * vec4(pos, uZ, 1);"
             "};";
 
-        const char* fragSrc =
-            "#version 330 core\n"
+        // gets the variants feature flags defined in front of it, see _SNZR_RECT_FEATURE_*
+        // the IS_ checks fold away to constants when a variant only draws one kind of instance
+        const char* fragBody =
             "out vec4 color;"
 
             "in vec2 vUv;"
             "in vec2 vCenterFromFragPos;"
             "in vec2 vRectHalfSize;"
+            "flat in vec4 vColor;"
+            "flat in vec4 vBorderColor;"
+            "flat in float vCornerRadius;"
+            "flat in float vBorderThickness;"
+            "flat in float vKind;"
+            "flat in float vSampleColorTex;"
 
-            "uniform vec4 uColor;"
             "uniform sampler2D uFontTexture;"
             "uniform sampler2D uColorTexture;"
-            "uniform float uCornerRadius;"
-
-            "uniform float uBorderThickness;"
-            "uniform vec4 uBorderColor;"
+            "\n"
+            "#define IS_RECT ((HAS_GLYPH == 0 && HAS_SDF_GLYPH == 0) || vKind < 0.5)\n"
+            "#define IS_GLYPH ((HAS_RECT == 0 && HAS_SDF_GLYPH == 0) || (vKind > 0.5 && vKind < 1.5))\n"
+            "#define IS_SDF_GLYPH ((HAS_RECT == 0 && HAS_GLYPH == 0) || vKind > 1.5)\n"
 
             "float roundedRectSDF(float r) {"
             "    vec2 d2 = abs(vCenterFromFragPos) - abs(vRectHalfSize) + vec2(r, r);"
@@ -543,21 +1799,87 @@ static void _snzr_init(snz_Arena* scratchArena) {
             "}"
 
             "void main() {"
-            "    vec4 textureColor = texture(uColorTexture, vUv);"
-            "    vec4 fontColor = vec4(1.0, 1.0, 1.0, texture(uFontTexture, vUv).r);"
-            "    color = uColor * textureColor * fontColor;"
-
-            "    float dist = roundedRectSDF(uCornerRadius);"
+            "    color = vColor;"
+            "\n#if TEXTURED\n"
+            "    color *= mix(vec4(1.0), texture(uColorTexture, vUv), vSampleColorTex);"
+            "\n#endif\n"
+            "\n#if HAS_GLYPH\n"
+            "    if (IS_GLYPH) {"
+            "        color.a *= texture(uFontTexture, vUv).r;"
+            "    }"
+            "\n#endif\n"
+            "\n#if HAS_SDF_GLYPH\n"
+            "    if (IS_SDF_GLYPH) {"
+            "        float d = texture(uFontTexture, vUv).r;"
+            "        float w = fwidth(d);"
+            "        color.a *= smoothstep(0.5 - w, 0.5 + w, d);"
+            "    }"
+            "\n#endif\n"
+            "\n#if ROUNDED\n"
+            "    float dist = roundedRectSDF(vCornerRadius);"
             "    if(dist > 0) {"
             "        discard;"
-            "    } else if(dist > -uBorderThickness) {"
-            "        color = uBorderColor;"
+            "    } else if(dist > -vBorderThickness) {"
+            "        color = vBorderColor;"
             "    }"
+            "\n#endif\n"
 
             "    if (color.a <= 0.01) { discard; }"
             "};";
-        _snzr_globs.rectShaderId = snzr_shaderInit(vertSrc, fragSrc, scratchArena);
-        _snzr_rectShaderLocationsInit(_snzr_globs.rectShaderId);
+
+        for (uint32_t features = 0; features < _SNZR_RECT_FEATURE_COMBO_COUNT; features++) {
+            bool hasRect = features & _SNZR_RECT_FEATURE_RECT;
+            bool hasAnyKind = features & (_SNZR_RECT_FEATURE_RECT | _SNZR_RECT_FEATURE_GLYPH | _SNZR_RECT_FEATURE_SDF_GLYPH);
+            bool hasRectOnlyFeatures = features & (_SNZR_RECT_FEATURE_ROUNDED | _SNZR_RECT_FEATURE_TEXTURED);
+            if (!hasAnyKind || (!hasRect && hasRectOnlyFeatures)) {
+                continue;  // no batch ends up with these
+            }
+
+            char fragSrc[4096];
+            int len = snprintf(fragSrc, sizeof(fragSrc),
+                               "#version 330 core\n"
+                               "#define HAS_RECT %d\n"
+                               "#define ROUNDED %d\n"
+                               "#define TEXTURED %d\n"
+                               "#define HAS_GLYPH %d\n"
+                               "#define HAS_SDF_GLYPH %d\n"
+                               "%s",
+                               hasRect,
+                               (features & _SNZR_RECT_FEATURE_ROUNDED) != 0,
+                               (features & _SNZR_RECT_FEATURE_TEXTURED) != 0,
+                               (features & _SNZR_RECT_FEATURE_GLYPH) != 0,
+                               (features & _SNZR_RECT_FEATURE_SDF_GLYPH) != 0,
+                               fragBody);
+            SNZ_ASSERT(len > 0 && len < (int)sizeof(fragSrc), "rect fragment shader source didn't fit.");
+
+            _snzr_RectShaderVariant* v = &_snzr_rectShaderVariants[features];
+            v->programId = snzr_shaderInit(vertSrc, fragSrc, scratchArena);
+            v->vpLoc = glGetUniformLocation(v->programId, "uVP");
+
+            // nothing else changes per batch, so set once here
+            _snzr_useProgram(v->programId);
+            glUniform1f(glGetUniformLocation(v->programId, "uZ"), 0);
+            glUniform1i(glGetUniformLocation(v->programId, "uFontTexture"), 0);
+            glUniform1i(glGetUniformLocation(v->programId, "uColorTexture"), 1);
+        }
+
+        snzr_callGLFnOrError(glGenVertexArrays(1, &_snzr_globs.rectBatchVAO));
+        _snzr_bindVertexArray(_snzr_globs.rectBatchVAO);
+        snzr_callGLFnOrError(glGenBuffers(1, &_snzr_globs.rectBatchVBO));
+        _snzr_bindArrayBuffer(_snzr_globs.rectBatchVBO);
+        snzr_callGLFnOrError(glBufferData(GL_ARRAY_BUFFER, sizeof(_snzr_rectBatch.instances), NULL, GL_STREAM_DRAW));
+        _snzr_rectBatchAttribInit(0, 2, offsetof(_snzr_RectInstance, dstStart));
+        _snzr_rectBatchAttribInit(1, 2, offsetof(_snzr_RectInstance, dstEnd));
+        _snzr_rectBatchAttribInit(2, 2, offsetof(_snzr_RectInstance, srcStart));
+        _snzr_rectBatchAttribInit(3, 2, offsetof(_snzr_RectInstance, srcEnd));
+        _snzr_rectBatchAttribInit(4, 2, offsetof(_snzr_RectInstance, clipStart));
+        _snzr_rectBatchAttribInit(5, 2, offsetof(_snzr_RectInstance, clipEnd));
+        _snzr_rectBatchAttribInit(6, 4, offsetof(_snzr_RectInstance, color));
+        _snzr_rectBatchAttribInit(7, 4, offsetof(_snzr_RectInstance, borderColor));
+        _snzr_rectBatchAttribInit(8, 1, offsetof(_snzr_RectInstance, cornerRadius));
+        _snzr_rectBatchAttribInit(9, 1, offsetof(_snzr_RectInstance, borderThickness));
+        _snzr_rectBatchAttribInit(10, 1, offsetof(_snzr_RectInstance, kind));
+        _snzr_rectBatchAttribInit(11, 1, offsetof(_snzr_RectInstance, sampleColorTex));
     }
 
     {
@@ -642,6 +1964,7 @@ static void _snzr_init(snz_Arena* scratchArena) {
     _snzr_globs.solidTex = snzr_textureInitRBGA(1, 1, solidTexData);
 }
 
+// batched, see snzr_flush
 void snzr_drawRect(
     HMM_Vec2 start,
     HMM_Vec2 end,
@@ -654,72 +1977,95 @@ void snzr_drawRect(
     HMM_Mat4 vp,
     snzr_Texture texture) {
     // FIXME: layering system
-    // FIXME: error safe gl calls
-    snzr_callGLFnOrError(glUseProgram(_snzr_globs.rectShaderId));
-
-    glUniformMatrix4fv(_snzr_rectShaderLocations.vp, 1, false, (float*)&vp);
-    glUniform1f(_snzr_rectShaderLocations.z, 0);
-    glUniform1f(_snzr_rectShaderLocations.cornerRadius, cornerRadius);
-
-    glUniform1f(_snzr_rectShaderLocations.borderThickness, borderThickness);
-    glUniform4f(_snzr_rectShaderLocations.borderColor, borderColor.X, borderColor.Y, borderColor.Z, borderColor.A);
-
-    glUniform2f(_snzr_rectShaderLocations.dstStart, start.X, start.Y);
-    glUniform2f(_snzr_rectShaderLocations.dstEnd, end.X, end.Y);
-
-    // flip vertically because we assume this is being used in pixel space, where 00 is in the UL corner
-    glUniform2f(_snzr_rectShaderLocations.srcStart, 0, 1);
-    glUniform2f(_snzr_rectShaderLocations.srcEnd, 1, 0);
-
-    glUniform2f(_snzr_rectShaderLocations.clipStart, clipStart.X, clipStart.Y);
-    glUniform2f(_snzr_rectShaderLocations.clipEnd, clipEnd.X, clipEnd.Y);
-
-    glUniform4f(_snzr_rectShaderLocations.color, color.X, color.Y, color.Z, color.W);
-
-    glUniform1i(_snzr_rectShaderLocations.fontTexture, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, _snzr_globs.solidTex.glId);
-
-    glUniform1i(_snzr_rectShaderLocations.colorTexture, 1);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, texture.glId);
-
-    snzr_callGLFnOrError(glDrawArrays(GL_TRIANGLES, 0, 6));
+    uint32_t features = _SNZR_RECT_FEATURE_RECT;
+    if (cornerRadius > 0 || borderThickness > 0) {
+        features |= _SNZR_RECT_FEATURE_ROUNDED;
+    }
+    uint32_t colorTexId = 0;  // solid rects have sampleColorTex off, so they can share a batch with any texture
+    if (texture.glId != _snzr_globs.solidTex.glId) {
+        colorTexId = texture.glId;
+        features |= _SNZR_RECT_FEATURE_TEXTURED;
+    }
+    _snzr_RectInstance* inst = _snzr_rectBatchPush(0, colorTexId, &vp, features);
+    *inst = (_snzr_RectInstance){
+        .dstStart = start,
+        .dstEnd = end,
+        // flip vertically because we assume this is being used in pixel space, where 00 is in the UL corner
+        .srcStart = HMM_V2(0, 1),
+        .srcEnd = HMM_V2(1, 0),
+        .clipStart = clipStart,
+        .clipEnd = clipEnd,
+        .color = color,
+        .borderColor = borderColor,
+        .cornerRadius = cornerRadius,
+        .borderThickness = borderThickness,
+        .kind = _SNZR_INSTANCE_KIND_RECT,
+        .sampleColorTex = colorTexId ? 1 : 0,
+    };
 }
 
-static const stbtt_packedchar* _snzr_getGylphFromChar(const snzr_Font* font, char c) {
-    int glyph = c - _SNZR_FONT_FIRST_ASCII;
-    if (glyph < 0) {
-        return &font->packRange.chardata_for_range[0];  // first is unknown char
-    } else if (glyph >= _SNZR_FONT_ASCII_CHAR_COUNT) {
-        return &font->packRange.chardata_for_range[0];
+// sums advances from the fonts ascii table, stopping at the first byte that isn't ascii
+// also counts newlines into outNewlineCount, and sets outByteCount to how far it got
+static float _snzr_advanceSumAscii(const float* advances, const uint8_t* str, uint64_t charCount, uint64_t* outNewlineCount, uint64_t* outByteCount) {
+    float x = 0;
+    uint64_t newlines = 0;
+    uint64_t i = 0;
+#ifdef __SSE2__
+    // SSE2 has no gather, so lanes are loaded from the table one at a time and then summed 4 wide
+    __m128 sums = _mm_setzero_ps();
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= charCount; i += 16) {
+        const uint8_t* b = &str[i];
+        __m128i bytes = _mm_loadu_si128((const __m128i*)b);
+        if (_mm_movemask_epi8(bytes) != 0) {
+            break;  // something in here is multibyte, let the scalar loop find where
+        }
+        newlines += _snz_popCount32((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+        for (int j = 0; j < 16; j += 4) {
+            sums = _mm_add_ps(sums, _mm_set_ps(advances[b[j + 3]], advances[b[j + 2]], advances[b[j + 1]], advances[b[j]]));
+        }
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sums);
+    x = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < charCount && str[i] < 128; i++) {
+        newlines += str[i] == '\n';
+        x += advances[str[i]];
     }
-    return &font->packRange.chardata_for_range[glyph + 1];
+    *outNewlineCount = newlines;
+    *outByteCount = i;
+    return x;
 }
 
+// str is utf8
 HMM_Vec2 snzr_strSize(const snzr_Font* font, const char* str, uint64_t charCount, float targetHeight) {
+    const uint8_t* bytes = (const uint8_t*)str;
     float x = 0;
-    uint64_t lineCount = 1;
-    for (uint64_t i = 0; i < charCount; i++) {
-        char c = str[i];
-        if (c == '\n') {
-            lineCount++;
-            continue;
-        } else if (c == '\r') {
-            continue;
-        } else if (c == '\t') {
-            continue;  // TODO: what exactly should i be doing here?
+    uint64_t newlines = 0;
+    uint64_t i = 0;
+    while (i < charCount) {
+        uint64_t runNewlines = 0;
+        uint64_t runLength = 0;
+        x += _snzr_advanceSumAscii(font->advances, &bytes[i], charCount - i, &runNewlines, &runLength);
+        newlines += runNewlines;
+        i += runLength;
+
+        if (i < charCount) {
+            uint64_t byteCount = 0;
+            uint32_t codepoint = _snzr_utf8Decode(&bytes[i], charCount - i, &byteCount);
+            x += _snzr_glyphGet(font->glyphs, codepoint)->xadvance;
+            i += byteCount;
         }
-        const stbtt_packedchar* glyph = _snzr_getGylphFromChar(font, str[i]);
-        x += glyph->xadvance;
     }
     float scaleFactor = targetHeight / font->renderedSize;
-    return HMM_Mul(HMM_V2(x, lineCount * font->renderedSize), scaleFactor);
+    return HMM_Mul(HMM_V2(x, (newlines + 1) * font->renderedSize), scaleFactor);
 }
 
-// FIXME: disgusting function all the way down
 // always renders with upwards on text being -, so do a matmul if that isn't ideal
 // when snap is on, rects per char get snapped to integer lines
+// str is utf8, glyphs that haven't been drawn before get rasterized into the fonts atlas
+// batched along with rects, see snzr_flush
 // FIXME: font should be a const*
 void snzr_drawTextScaled(HMM_Vec2 start,
                          HMM_Vec2 clipStart,
@@ -732,56 +2078,38 @@ void snzr_drawTextScaled(HMM_Vec2 start,
                          float targetSize,
                          bool snap) {
     // FIXME: layering system
-    // FIXME: safe gl calls
-    snzr_callGLFnOrError(glUseProgram(_snzr_globs.rectShaderId));
-    glUniformMatrix4fv(_snzr_rectShaderLocations.vp, 1, false, (float*)&vp);
-    glUniform1f(_snzr_rectShaderLocations.z, 0);
-    glUniform4f(_snzr_rectShaderLocations.color, color.X, color.Y, color.Z, color.W);
-    glUniform1i(_snzr_rectShaderLocations.fontTexture, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, font.atlas.glId);
-
-    glUniform1f(_snzr_rectShaderLocations.cornerRadius, 0);
-    glUniform1f(_snzr_rectShaderLocations.borderThickness, 0);
-    glUniform4f(_snzr_rectShaderLocations.borderColor, 0, 0, 0, 0);
-
-    glUniform2f(_snzr_rectShaderLocations.clipStart, clipStart.X, clipStart.Y);
-    glUniform2f(_snzr_rectShaderLocations.clipEnd, clipEnd.X, clipEnd.Y);
-
     float scaleFactor = targetSize / font.renderedSize;
+    HMM_Vec2 uvScale = HMM_V2(1.0f / font.atlas.width, 1.0f / font.atlas.height);
+    uint32_t kind = _SNZR_INSTANCE_KIND_GLYPH;
+    uint32_t features = _SNZR_RECT_FEATURE_GLYPH;
+    if (font.glyphs->sdf) {
+        kind = _SNZR_INSTANCE_KIND_SDF_GLYPH;
+        features = _SNZR_RECT_FEATURE_SDF_GLYPH;
+    }
 
     HMM_Vec2 drawPos = HMM_V2(start.X, start.Y);
-    assert(charCount < INT64_MAX);
-    for (const char* c = str; *c != 0; c++) {
-        if ((c - str) >= (int64_t)charCount) {
-            break;
-        }
-        if (*c == '\n') {
+    const uint8_t* bytes = (const uint8_t*)str;
+    uint64_t byteCount = 0;
+    for (uint64_t i = 0; i < charCount && bytes[i] != 0; i += byteCount) {
+        uint32_t codepoint = _snzr_utf8Decode(&bytes[i], charCount - i, &byteCount);
+        if (codepoint == '\n') {
             drawPos.Y += (font.lineGap + font.ascent - font.descent) * scaleFactor;
             drawPos.X = start.X;
             continue;
-        } else if (*c == '\r') {
+        } else if (codepoint == '\r' || codepoint == '\t') {
             continue;
         }
 
-        HMM_Vec2 srcStart = HMM_V2(0, 0);
-        HMM_Vec2 srcEnd = HMM_V2(0, 0);
-        HMM_Vec2 dstStart = HMM_V2(0, 0);
-        HMM_Vec2 dstEnd = HMM_V2(0, 0);
-        {
-            const stbtt_packedchar* b = _snzr_getGylphFromChar(&font, *c);
-
-            HMM_Vec2 s = HMM_MulV2F(HMM_V2(b->xoff, b->yoff), scaleFactor);
-            HMM_Vec2 e = HMM_MulV2F(HMM_V2(b->xoff2, b->yoff2), scaleFactor);
-            dstStart = HMM_AddV2(drawPos, s);
-            dstEnd = HMM_AddV2(dstStart, HMM_Sub(e, s));
-
-            HMM_Vec2 uvScale = HMM_V2(1.0f / font.atlas.width, 1.0f / font.atlas.height);
-            srcStart = HMM_MulV2(HMM_V2(b->x0, b->y0), uvScale);
-            srcEnd = HMM_MulV2(HMM_V2(b->x1, b->y1), uvScale);
-
-            drawPos.X += b->xadvance * scaleFactor;
+        _snzr_Glyph* b = _snzr_glyphGet(font.glyphs, codepoint);
+        if (!b->rasterized) {
+            _snzr_glyphRasterize(font.glyphs, font.atlas, b);
         }
+        HMM_Vec2 s = HMM_MulV2F(HMM_V2(b->xoff, b->yoff), scaleFactor);
+        HMM_Vec2 e = HMM_MulV2F(HMM_V2(b->xoff2, b->yoff2), scaleFactor);
+        HMM_Vec2 dstStart = HMM_AddV2(drawPos, s);
+        HMM_Vec2 dstEnd = HMM_AddV2(dstStart, HMM_Sub(e, s));
+        drawPos.X += b->xadvance * scaleFactor;
+
         if (snap) {
             dstStart.X = (int)dstStart.X;
             dstStart.Y = (int)dstStart.Y;
@@ -789,11 +2117,27 @@ void snzr_drawTextScaled(HMM_Vec2 start,
             dstEnd.Y = (int)dstEnd.Y;
         }
 
-        glUniform2f(_snzr_rectShaderLocations.srcStart, srcStart.X, srcStart.Y);
-        glUniform2f(_snzr_rectShaderLocations.srcEnd, srcEnd.X, srcEnd.Y);
-        glUniform2f(_snzr_rectShaderLocations.dstStart, dstStart.X, dstStart.Y);
-        glUniform2f(_snzr_rectShaderLocations.dstEnd, dstEnd.X, dstEnd.Y);
-        snzr_callGLFnOrError(glDrawArrays(GL_TRIANGLES, 0, 6));
+        // spaces and such have nothing to draw
+        if (b->x0 == b->x1 || b->y0 == b->y1) {
+            continue;
+        }
+
+        _snzr_RectInstance* inst = _snzr_rectBatchPush(font.atlas.glId, 0, &vp, features);
+        *inst = (_snzr_RectInstance){
+            .dstStart = dstStart,
+            .dstEnd = dstEnd,
+            .srcStart = HMM_MulV2(HMM_V2(b->x0, b->y0), uvScale),
+            .srcEnd = HMM_MulV2(HMM_V2(b->x1, b->y1), uvScale),
+            .clipStart = clipStart,
+            .clipEnd = clipEnd,
+            .color = color,
+            .borderColor = HMM_V4(0, 0, 0, 0),
+            .cornerRadius = 0,
+            .borderThickness = 0,
+            .kind = kind,
+            .sampleColorTex = 0,
+        };
+        _snzr_glState.frameStats.glyphs++;
     }
 }
 
@@ -827,7 +2171,8 @@ void snzr_drawLineFaded(
     if (ptCount < 2) {
         return;
     }
-    snzr_callGLFnOrError(glUseProgram(_snzr_globs.lineShaderId));
+    snzr_flush();
+    _snzr_useProgram(_snzr_globs.lineShaderId);
 
     int loc = glGetUniformLocation(_snzr_globs.lineShaderId, "uColor");
     glUniform4f(loc, color.X, color.Y, color.Z, color.W);
@@ -860,6 +2205,7 @@ void snzr_drawLineFaded(
 
     snzr_callGLFnOrError(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _snzr_globs.lineShaderSSBOId));
     snzr_callGLFnOrError(glDrawArrays(GL_TRIANGLES, 0, (ptCount - 1) * 6));
+    _snzr_glState.frameStats.drawCalls++;
 }
 
 // end miters automatically added, pointing straight away
@@ -871,6 +2217,184 @@ void snzr_drawLine(HMM_Vec4* pts, uint64_t ptCount, HMM_Vec4 color, float thickn
 // RENDER ======================================================================
 // RENDER ======================================================================
 
+// FRAME PROFILER ==============================================================
+// opt in by compiling with -DSNZ_PROFILE
+// snz_main times each phase of every frame on the cpu, times the whole frame on the gpu with GL_TIME_ELAPSED
+// queries, and keeps the last _SNZ_PROFILE_HISTORY_SIZE frames around along with some counters.
+// see snzuc_profilePanel for an overlay, and snz_profileDumpCsv for getting them out
+// not thread safe, everything here is for the main thread
+#ifdef SNZ_PROFILE
+
+typedef enum {
+    SNZ_PROFILE_PHASE_EVENTS,
+    SNZ_PROFILE_PHASE_BUILD,  // frameFunc, not counting the phases below that happen inside of it
+    SNZ_PROFILE_PHASE_LAYOUT,  // resolving box positions and clips
+    SNZ_PROFILE_PHASE_DRAW,
+    SNZ_PROFILE_PHASE_INTERACTIONS,
+    SNZ_PROFILE_PHASE_ARENA_CLEAR,
+    SNZ_PROFILE_PHASE_SWAP,  // includes waiting on vsync
+    SNZ_PROFILE_PHASE_COUNT,
+} snz_ProfilePhase;
+
+static const char* _snz_profilePhaseNames[SNZ_PROFILE_PHASE_COUNT] = {
+    "events",
+    "build",
+    "layout",
+    "draw",
+    "interactions",
+    "arena clear",
+    "swap",
+};
+
+typedef struct {
+    float cpuMs[SNZ_PROFILE_PHASE_COUNT];
+    float frameMs;  // cpu time of the whole frame, not counting time spent idle waiting for input
+    float gpuMs;  // negative until the query for this frame comes back, which takes a couple frames
+    uint64_t boxes;
+    uint64_t drawCalls;
+    uint64_t glyphs;
+    uint64_t useMemLookups;
+    uint64_t arenaBytes;  // used in the frame arena right before it was cleared
+} snz_ProfileFrame;
+
+#define _SNZ_PROFILE_HISTORY_SIZE 240
+#define _SNZ_PROFILE_QUERY_COUNT 4  // frames of gpu timings that can be in flight
+
+static struct {
+    snz_ProfileFrame history[_SNZ_PROFILE_HISTORY_SIZE];
+    uint64_t frameCount;  // frames finished, the one in progress goes into history[frameCount % size]
+    snz_ProfileFrame current;
+    uint64_t frameStart;
+    uint64_t phaseStarts[SNZ_PROFILE_PHASE_COUNT];
+
+    uint32_t queries[_SNZ_PROFILE_QUERY_COUNT];
+    uint64_t queryFrames[_SNZ_PROFILE_QUERY_COUNT];  // frameCount + 1 of the frame each query timed, 0 when free
+} _snz_profile;
+
+#define _SNZ_PROFILE_BEGIN(phase) _snz_profileBegin(phase)
+#define _SNZ_PROFILE_END(phase) _snz_profileEnd(phase)
+#define _SNZ_PROFILE_COUNT(counter, n) (_snz_profile.current.counter += (n))
+
+static float _snz_profileTicksToMs(uint64_t ticks) {
+    return (float)((double)ticks * 1000 / (double)SDL_GetPerformanceFrequency());
+}
+
+static void _snz_profileBegin(snz_ProfilePhase phase) {
+    _snz_profile.phaseStarts[phase] = SDL_GetPerformanceCounter();
+}
+
+// phases can be timed more than once a frame, times add up
+static void _snz_profileEnd(snz_ProfilePhase phase) {
+    uint64_t ticks = SDL_GetPerformanceCounter() - _snz_profile.phaseStarts[phase];
+    _snz_profile.current.cpuMs[phase] += _snz_profileTicksToMs(ticks);
+}
+
+// fills in the gpu time of any frames whose queries are done, without waiting on the ones that aren't
+static void _snz_profileCollectQueries() {
+    for (int i = 0; i < _SNZ_PROFILE_QUERY_COUNT; i++) {
+        uint64_t frame = _snz_profile.queryFrames[i];
+        if (!frame) {
+            continue;
+        }
+        int available = 0;
+        snzr_callGLFnOrError(glGetQueryObjectiv(_snz_profile.queries[i], GL_QUERY_RESULT_AVAILABLE, &available));
+        if (!available) {
+            continue;
+        }
+        uint64_t nanos = 0;
+        snzr_callGLFnOrError(glGetQueryObjectui64v(_snz_profile.queries[i], GL_QUERY_RESULT, &nanos));
+        _snz_profile.queryFrames[i] = 0;
+        frame--;
+        if (_snz_profile.frameCount - frame <= _SNZ_PROFILE_HISTORY_SIZE) {  // may have been overwritten already
+            _snz_profile.history[frame % _SNZ_PROFILE_HISTORY_SIZE].gpuMs = (float)((double)nanos / 1000000);
+        }
+    }
+}
+
+// call before anything gets drawn, gl needs to be loaded
+static void _snz_profileFrameBegin() {
+    if (!_snz_profile.queries[0]) {
+        snzr_callGLFnOrError(glGenQueries(_SNZ_PROFILE_QUERY_COUNT, _snz_profile.queries));
+    }
+    _snz_profileCollectQueries();
+
+    _snz_profile.frameStart = SDL_GetPerformanceCounter();
+    _snz_profile.current = (snz_ProfileFrame){ .gpuMs = -1 };
+
+    // a query still out from QUERY_COUNT frames ago is too slow to wait on, that frame just doesn't get a gpu time
+    int slot = _snz_profile.frameCount % _SNZ_PROFILE_QUERY_COUNT;
+    _snz_profile.queryFrames[slot] = _snz_profile.frameCount + 1;
+    snzr_callGLFnOrError(glBeginQuery(GL_TIME_ELAPSED, _snz_profile.queries[slot]));
+}
+
+// call once everything has been drawn, before snzr stats get rolled over and before the arena is cleared
+static void _snz_profileFrameGather(const snz_Arena* frameArena) {
+    snzr_callGLFnOrError(glEndQuery(GL_TIME_ELAPSED));
+    snz_ProfileFrame* f = &_snz_profile.current;
+    f->drawCalls = _snzr_glState.frameStats.drawCalls;
+    f->glyphs = _snzr_glState.frameStats.glyphs;
+    f->arenaBytes = (const char*)(frameArena->end) - (const char*)(frameArena->start);
+}
+
+// call at the very end of the frame
+static void _snz_profileFrameEnd() {
+    snz_ProfileFrame* f = &_snz_profile.current;
+    f->frameMs = _snz_profileTicksToMs(SDL_GetPerformanceCounter() - _snz_profile.frameStart);
+    float nested = f->cpuMs[SNZ_PROFILE_PHASE_LAYOUT] + f->cpuMs[SNZ_PROFILE_PHASE_DRAW] + f->cpuMs[SNZ_PROFILE_PHASE_INTERACTIONS];
+    f->cpuMs[SNZ_PROFILE_PHASE_BUILD] = SNZ_MAX(0, f->cpuMs[SNZ_PROFILE_PHASE_BUILD] - nested);
+
+    _snz_profile.history[_snz_profile.frameCount % _SNZ_PROFILE_HISTORY_SIZE] = *f;
+    _snz_profile.frameCount++;
+}
+
+// ago 0 is the last finished frame, NULL if the frame isn't in the history anymore
+const snz_ProfileFrame* snz_profileGetFrame(uint64_t ago) {
+    if (ago >= _SNZ_PROFILE_HISTORY_SIZE || ago >= _snz_profile.frameCount) {
+        return NULL;
+    }
+    return &_snz_profile.history[(_snz_profile.frameCount - 1 - ago) % _SNZ_PROFILE_HISTORY_SIZE];
+}
+
+// writes every frame in the history to path as csv, oldest first. Overwrites whatever was there
+// false if the file couldn't be opened
+bool snz_profileDumpCsv(const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        return false;
+    }
+
+    fprintf(f, "frame");
+    for (int i = 0; i < SNZ_PROFILE_PHASE_COUNT; i++) {
+        fprintf(f, ",%s ms", _snz_profilePhaseNames[i]);
+    }
+    fprintf(f, ",frame ms,gpu ms,boxes,draw calls,glyphs,usemem lookups,arena bytes\n");
+
+    uint64_t count = SNZ_MIN(_snz_profile.frameCount, _SNZ_PROFILE_HISTORY_SIZE);
+    for (uint64_t ago = count; ago > 0; ago--) {
+        uint64_t frameIdx = _snz_profile.frameCount - ago;
+        const snz_ProfileFrame* frame = snz_profileGetFrame(ago - 1);
+        fprintf(f, "%" PRIu64, frameIdx);
+        for (int i = 0; i < SNZ_PROFILE_PHASE_COUNT; i++) {
+            fprintf(f, ",%.4f", frame->cpuMs[i]);
+        }
+        fprintf(f, ",%.4f,%.4f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+                frame->frameMs, frame->gpuMs,
+                frame->boxes, frame->drawCalls, frame->glyphs, frame->useMemLookups, frame->arenaBytes);
+    }
+    fclose(f);
+    return true;
+}
+
+#else
+
+#define _SNZ_PROFILE_BEGIN(phase)
+#define _SNZ_PROFILE_END(phase)
+#define _SNZ_PROFILE_COUNT(counter, n)
+
+#endif
+
+// FRAME PROFILER ==============================================================
+
 // UI ==========================================================================
 // UI ==========================================================================
 // UI ==========================================================================
@@ -954,29 +2478,65 @@ struct snzu_Interaction {
 
 // FIXME: opaque ptr type
 
+// only allocated once a box gets a color, border, corner radius or texture
+typedef struct {
+    HMM_Vec4 color;
+    HMM_Vec4 borderColor;
+    float cornerRadius;
+    float borderThickness;
+    snzr_Texture texture;
+} _snzu_BoxStyle;
+
+// only allocated once a box gets a display str
+typedef struct {
+    const char* str;
+    uint64_t len;
+    const snzr_Font* font;
+    HMM_Vec4 color;
+    bool removeSnap;
+    float renderedHeight;
+
+    // so fitting and drawing don't both measure, cleared whenever anything above changes
+    bool sizeValid;
+    HMM_Vec2 size;
+} _snzu_BoxText;
+
+// measures the first time and returns the stored size after that
+static HMM_Vec2 _snzu_boxTextSize(_snzu_BoxText* text) {
+    if (!text->sizeValid) {
+        text->size = snzr_strSize(text->font, text->str, text->len, text->renderedHeight);
+        text->sizeValid = true;
+    }
+    return text->size;
+}
+
+// persistent state for a box marked with snzu_boxSetCached, lives in useMem under that box
+typedef struct {
+    snzr_FrameBuffer frameBuffer;  // zeroed until the first time the children get drawn
+    uint64_t key;  // built up while the frame is built, see _snzu_boxCacheMix
+    uint64_t renderedKey;  // key of whatever is in the frame buffer now
+} _snzu_BoxCache;
+
+// kept small because every box gets one each frame, style and text only exist for boxes that set them
 typedef struct _snzu_Box _snzu_Box;
 struct _snzu_Box {
     uint64_t pathHash;
     const char* tag;
 
+    // while building, start and end don't include moves made to parents after this box was placed
+    // those are held in the parents childOffset, and get pushed down when the frame is drawn
+    // so only read these through _snzu_boxAbsStart/End until then
     HMM_Vec2 start;
     HMM_Vec2 end;
-    HMM_Vec4 color;
-    float cornerRadius;
-    float borderThickness;
-    HMM_Vec4 borderColor;
-    snzr_Texture texture;
+    HMM_Vec2 childOffset;  // moves applied to this box that haven't been applied to its children yet
 
-    const char* displayStr;
-    uint64_t displayStrLen;
-    const snzr_Font* font;
-    HMM_Vec4 displayStrColor;
-    bool displayStrRemoveSnap;
-    float displayStrRenderedHeight;
+    _snzu_BoxStyle* style;  // NULL draws nothing
+    _snzu_BoxText* text;  // NULL for no text
 
     HMM_Vec2 clippedStart;
     HMM_Vec2 clippedEnd;
     bool clipChildren;
+    _snzu_BoxCache* cache;  // NULL unless snzu_boxSetCached was called on this box
 
     snzu_Interaction* interactionTarget;
     snzu_InteractionFlags interactionMask;
@@ -990,12 +2550,37 @@ struct _snzu_Box {
 
 typedef struct {
     uint64_t lastFrameTouched;
+    uint64_t touchedListMark;  // currentFrameIdx + 1 of the frame this was last put on the touched list, 0 for never
     uint64_t allocSize;
     void* alloc;
     uint64_t pathHash;
     bool inUse;
+    uint64_t nextFree;  // index + 1 of the next free node when not in use, 0 ends the list
 } _snzu_useMemAllocNode;
-#define _SNZU_USEMEM_MAX_ALLOCS 8000
+#define _SNZU_USEMEM_INITIAL_CAPACITY 256
+
+// useMem payloads come from power of 2 size classes, anything bigger than the largest gets its own calloc
+#define _SNZU_USEMEM_MIN_CLASS_SIZE 16
+#define _SNZU_USEMEM_SIZE_CLASS_COUNT 9  // 16 bytes up to 4kb
+#define _SNZU_USEMEM_POOL_CHUNK_SIZE 65536
+
+typedef struct _snzu_UseMemPoolChunk _snzu_UseMemPoolChunk;
+struct _snzu_UseMemPoolChunk {
+    _snzu_UseMemPoolChunk* next;
+    uint64_t _pad;  // keeps blocks after the header 16 byte aligned
+};
+
+// node indices touched during one frame, each node shows up at most once
+typedef struct {
+    uint32_t* idxs;
+    uint64_t count;
+    uint64_t capacity;
+} _snzu_UseMemTouchedList;
+
+typedef struct {
+    void* freeLists[_SNZU_USEMEM_SIZE_CLASS_COUNT];  // first 8 bytes of each free block point to the next one
+    _snzu_UseMemPoolChunk* firstChunk;  // only kept around to free everything on deinit
+} _snzu_UseMemPool;
 
 typedef struct {
     HMM_Vec2 mousePos;
@@ -1008,13 +2593,59 @@ typedef struct {
     bool doubleClick;  // only lmb
 } snzu_Input;
 
+SNZ_HASH_MAP_NAMED(uint64_t, _snzu_Box*, _snzu_BoxIndex);
+SNZ_DYNARR_NAMED(_snzu_Box*, _snzu_BoxPtrDynArr);
+
+// counts from the last snzu_frameDrawAndGenInteractions
+typedef struct {
+    uint64_t boxes;
+    uint64_t rectsDrawn;
+    uint64_t textsDrawn;
+    uint64_t culledInvisible;  // styled boxes with no area or with a fully transparent fill and border
+    uint64_t culledClipped;  // rects and texts skipped because they were entirely outside of their clip
+    uint64_t cachesRedrawn;  // cached boxes whose children had to be drawn into their frame buffer again
+    uint64_t cachesReused;
+    bool drawSkipped;  // nothing changed since the last frame, so nothing got drawn
+} snzu_FrameStats;
+
+// frame damage state shared by every instance, snz_main resets it at the end of each frame
+// starts out forcing redraws, so nothing gets skipped unless snz_main is keeping it up to date
+static struct {
+    bool forceRedraw;  // set when what's on screen can't be trusted, like after the window was resized or uncovered
+    uint64_t instancesDrawn;  // snzu_frameDrawAndGenInteractions calls this frame
+    uint64_t instancesDrawnLastFrame;  // if more than one instance draws, any of them skipping would erase it
+    uint64_t instancesSkipped;
+} _snzu_damage = { .forceRedraw = true };
+
+// skipped frames assume that snzu draws everything on screen, call this on frames where something else is drawn
+// before snzu_frameDrawAndGenInteractions
+void snzu_forceRedraw() {
+    _snzu_damage.forceRedraw = true;
+}
+
 typedef struct {
     _snzu_Box treeParent;
     _snzu_Box* currentParentBox;
     _snzu_Box* selectedBox;
     snz_Arena* frameArena;
-
-    _snzu_useMemAllocNode useMemAllocs[_SNZU_USEMEM_MAX_ALLOCS];
+    _snzu_BoxIndex boxesByPathHash;  // every box made this frame, lives in the frame arena
+    _snzu_BoxPtrDynArr interactiveBoxes;  // boxes with an interaction mask or target, in draw order. filled when resolving
+    snzu_FrameStats frameStats;
+    uint64_t lastDrawHash;  // of what was drawn the last time a frame wasn't skipped
+
+    // nodes live in a growable array so indices stay stable, useMemSlots is an open addressed table
+    // keyed on pathHash (linearly probed), holding node index + 1 (0 is empty)
+    _snzu_useMemAllocNode* useMemNodes;
+    uint64_t useMemNodeCount;  // high water mark of nodes ever used
+    uint64_t useMemNodeCapacity;
+    uint64_t useMemFirstFreeNode;  // index + 1, 0 when there are no free nodes below useMemNodeCount
+    uint32_t* useMemSlots;
+    uint64_t useMemSlotCapacity;  // power of 2
+    uint64_t useMemLiveCount;
+    _snzu_UseMemPool useMemPool;
+    // every live node is in one of these, so sweeping only has to look at what was touched last frame
+    _snzu_UseMemTouchedList useMemTouchedThisFrame;
+    _snzu_UseMemTouchedList useMemTouchedLastFrame;
     bool useMemIsLastAllocTouchedNew;
     uint64_t currentFrameIdx;
     float timeSinceLastFrame;
@@ -1031,57 +2662,230 @@ typedef struct {
 } snzu_Instance;
 static snzu_Instance* _snzu_instance;
 
+// mixes a key into its parents path hash, order matters so 'a' in 'b' doesn't land on 'b' in 'a'
+static uint64_t _snzu_hashCombine(uint64_t parentPathHash, uint64_t key) {
+    uint64_t h = parentPathHash * 0x9E3779B97F4A7C15ull + key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
 static uint64_t _snzu_generatePathHash(uint64_t parentPathHash, const char* tag) {
-    // stolen, https://stackoverflow.com/questions/7666509/hash-function-for-string
-    uint32_t tagHash = 5381;
-    uint8_t c;
-    while ((c = *tag++)) {
-        tagHash = ((tagHash << 5) + tagHash) + c; /* hash * 33 + c */
+    return _snzu_hashCombine(parentPathHash, _snz_hashBytes(tag, strlen(tag)));
+}
+
+// keeps pointer keys from landing on the same integer passed to snzu_boxNewU64
+#define _SNZU_PTR_KEY_SALT 0x5bd1e9955bd1e995ull
+
+// -1 for sizes too big to pool
+static int64_t _snzu_useMemSizeClass(uint64_t size) {
+    uint64_t classSize = _SNZU_USEMEM_MIN_CLASS_SIZE;
+    for (int64_t i = 0; i < _SNZU_USEMEM_SIZE_CLASS_COUNT; i++) {
+        if (size <= classSize) {
+            return i;
+        }
+        classSize *= 2;
+    }
+    return -1;
+}
+
+// returns zeroed memory
+static void* _snzu_useMemPoolAlloc(_snzu_UseMemPool* pool, uint64_t size) {
+    int64_t sizeClass = _snzu_useMemSizeClass(size);
+    if (sizeClass < 0) {
+        void* out = calloc(1, size);
+        SNZ_ASSERT(out, "allocating new usemem alloc failed.");
+        return out;
+    }
+
+    uint64_t classSize = _SNZU_USEMEM_MIN_CLASS_SIZE << sizeClass;
+    if (!pool->freeLists[sizeClass]) {
+        _snzu_UseMemPoolChunk* chunk = malloc(sizeof(_snzu_UseMemPoolChunk) + _SNZU_USEMEM_POOL_CHUNK_SIZE);
+        SNZ_ASSERT(chunk, "allocating new usemem pool chunk failed.");
+        chunk->next = pool->firstChunk;
+        pool->firstChunk = chunk;
+
+        char* blocks = (char*)(chunk + 1);
+        for (uint64_t i = 0; i < _SNZU_USEMEM_POOL_CHUNK_SIZE / classSize; i++) {
+            void* block = blocks + i * classSize;
+            *(void**)block = pool->freeLists[sizeClass];
+            pool->freeLists[sizeClass] = block;
+        }
+    }
+
+    void* out = pool->freeLists[sizeClass];
+    pool->freeLists[sizeClass] = *(void**)out;
+    memset(out, 0, classSize);
+    return out;
+}
+
+// size should be the same as what was passed to alloc
+static void _snzu_useMemPoolFree(_snzu_UseMemPool* pool, void* alloc, uint64_t size) {
+    int64_t sizeClass = _snzu_useMemSizeClass(size);
+    if (sizeClass < 0) {
+        free(alloc);
+        return;
+    }
+    *(void**)alloc = pool->freeLists[sizeClass];
+    pool->freeLists[sizeClass] = alloc;
+}
+
+static uint64_t _snzu_useMemHomeSlot(uint64_t pathHash) {
+    return ((pathHash * 0x9E3779B97F4A7C15ull) >> 32) & (_snzu_instance->useMemSlotCapacity - 1);
+}
+
+// returns the slot holding pathHash, or the empty slot where it would go
+static uint64_t _snzu_useMemFindSlot(uint64_t pathHash) {
+    uint64_t mask = _snzu_instance->useMemSlotCapacity - 1;
+    uint64_t slot = _snzu_useMemHomeSlot(pathHash);
+    while (true) {
+        uint32_t idx = _snzu_instance->useMemSlots[slot];
+        if (idx == 0 || _snzu_instance->useMemNodes[idx - 1].pathHash == pathHash) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+static void _snzu_useMemResizeSlots(uint64_t newCapacity) {
+    free(_snzu_instance->useMemSlots);
+    _snzu_instance->useMemSlotCapacity = newCapacity;
+    _snzu_instance->useMemSlots = calloc(newCapacity, sizeof(*_snzu_instance->useMemSlots));
+    SNZ_ASSERT(_snzu_instance->useMemSlots, "allocating usemem table failed.");
+    for (uint64_t i = 0; i < _snzu_instance->useMemNodeCount; i++) {
+        _snzu_useMemAllocNode* node = &_snzu_instance->useMemNodes[i];
+        if (node->inUse) {
+            _snzu_instance->useMemSlots[_snzu_useMemFindSlot(node->pathHash)] = (uint32_t)(i + 1);
+        }
+    }
+}
+
+// empties the slot and shifts back anything after it in the probe run, so no tombstones are needed
+static void _snzu_useMemRemoveSlot(uint64_t slot) {
+    uint64_t mask = _snzu_instance->useMemSlotCapacity - 1;
+    uint32_t* slots = _snzu_instance->useMemSlots;
+    uint64_t hole = slot;
+    uint64_t i = slot;
+    while (true) {
+        i = (i + 1) & mask;
+        if (slots[i] == 0) {
+            break;
+        }
+        uint64_t home = _snzu_useMemHomeSlot(_snzu_instance->useMemNodes[slots[i] - 1].pathHash);
+        // entries whose home is cyclically within (hole, i] are still reachable and stay put
+        bool reachable = (hole <= i) ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (!reachable) {
+            slots[hole] = slots[i];
+            hole = i;
+        }
+    }
+    slots[hole] = 0;
+}
+
+// frees the payload and returns the node to the free list
+static void _snzu_useMemRetire(uint64_t nodeIdx) {
+    _snzu_useMemAllocNode* node = &_snzu_instance->useMemNodes[nodeIdx];
+    _snzu_useMemRemoveSlot(_snzu_useMemFindSlot(node->pathHash));
+    _snzu_useMemPoolFree(&_snzu_instance->useMemPool, node->alloc, node->allocSize);
+    memset(node, 0, sizeof(*node));
+    node->nextFree = _snzu_instance->useMemFirstFreeNode;
+    _snzu_instance->useMemFirstFreeNode = nodeIdx + 1;
+    _snzu_instance->useMemLiveCount--;
+}
+
+static void _snzu_useMemMarkTouched(_snzu_useMemAllocNode* node) {
+    node->lastFrameTouched = _snzu_instance->currentFrameIdx;
+    // a double useMem only asserts, so without this check NDEBUG builds would list the node twice and retire it twice
+    if (node->touchedListMark == _snzu_instance->currentFrameIdx + 1) {
+        return;
+    }
+    node->touchedListMark = _snzu_instance->currentFrameIdx + 1;
+
+    _snzu_UseMemTouchedList* list = &_snzu_instance->useMemTouchedThisFrame;
+    if (list->count >= list->capacity) {
+        list->capacity = SNZ_MAX(list->capacity * 2, _SNZU_USEMEM_INITIAL_CAPACITY);
+        list->idxs = realloc(list->idxs, list->capacity * sizeof(*list->idxs));
+        SNZ_ASSERT(list->idxs, "growing usemem touched list failed.");
+    }
+    list->idxs[list->count] = (uint32_t)(node - _snzu_instance->useMemNodes);
+    list->count++;
+}
+
+static _snzu_useMemAllocNode* _snzu_useMemNewNode() {
+    snzu_Instance* inst = _snzu_instance;
+    uint64_t idx = 0;
+    if (inst->useMemFirstFreeNode) {
+        idx = inst->useMemFirstFreeNode - 1;
+        inst->useMemFirstFreeNode = inst->useMemNodes[idx].nextFree;
+    } else {
+        if (inst->useMemNodeCount >= inst->useMemNodeCapacity) {
+            inst->useMemNodeCapacity = SNZ_MAX(inst->useMemNodeCapacity * 2, _SNZU_USEMEM_INITIAL_CAPACITY);
+            inst->useMemNodes = realloc(inst->useMemNodes, inst->useMemNodeCapacity * sizeof(*inst->useMemNodes));
+            SNZ_ASSERT(inst->useMemNodes, "growing usemem nodes failed.");
+        }
+        idx = inst->useMemNodeCount;
+        inst->useMemNodeCount++;
     }
-    return tagHash + parentPathHash;  // FIXME: is this problematic at all?
+    _snzu_useMemAllocNode* node = &inst->useMemNodes[idx];
+    memset(node, 0, sizeof(*node));
+    return node;
 }
 
 // returns an initially zeroed piece of memory that will persist between frames
-// memory is automatically freed when it is not used (with the same size) for a frame
+// memory is automatically freed when it is not used for a frame
 // tag must be unique with all siblings inside the current parent box
-// size is ignored on a repeat allocation // FIXME: shouldn't be tho :)
+// if size changes on a repeat allocation the memory is moved to a new alloc of the new size,
+// keeping the contents that fit and zeroing any new space.
 // TODO: invalid access unit tests
 // TODO: unit tests when input is done
 void* snzu_useMem(uint64_t size, const char* tag) {
+    _SNZ_PROFILE_COUNT(useMemLookups, 1);
     _snzu_Box* pathTarget = _snzu_instance->selectedBox;
     uint64_t pathHash = _snzu_generatePathHash(pathTarget->pathHash, tag);
 
-    // first check if there is a node out there that correllates with this ones tag
-    _snzu_useMemAllocNode* firstFree = NULL;
-    for (uint64_t i = 0; i < _SNZU_USEMEM_MAX_ALLOCS; i++) {
-        _snzu_useMemAllocNode* node = &_snzu_instance->useMemAllocs[i];
-        if (!node->inUse) {
-            if (!firstFree) {
-                firstFree = node;
-            }
-            continue;
-        } else if (node->pathHash == pathHash) {
-            if (node->lastFrameTouched != _snzu_instance->currentFrameIdx - 1) {
-                // FIXME: this shit needs a better error message
-                // like include the parent trace, not just the last level
-                SNZ_ASSERTF(false, "double usememmed tag '%s'", tag);
-            }
-            node->lastFrameTouched = _snzu_instance->currentFrameIdx;
-            _snzu_instance->useMemIsLastAllocTouchedNew = false;
-            return node->alloc;
+    if (!_snzu_instance->useMemSlots) {
+        _snzu_useMemResizeSlots(_SNZU_USEMEM_INITIAL_CAPACITY);
+    }
+
+    uint64_t slot = _snzu_useMemFindSlot(pathHash);
+    uint32_t idx = _snzu_instance->useMemSlots[slot];
+    if (idx) {
+        _snzu_useMemAllocNode* node = &_snzu_instance->useMemNodes[idx - 1];
+        if (node->lastFrameTouched != _snzu_instance->currentFrameIdx - 1) {
+            // FIXME: this shit needs a better error message
+            // like include the parent trace, not just the last level
+            SNZ_ASSERTF(false, "double usememmed tag '%s'", tag);
         }
+        if (node->allocSize != size) {
+            void* newAlloc = _snzu_useMemPoolAlloc(&_snzu_instance->useMemPool, size);
+            memcpy(newAlloc, node->alloc, SNZ_MIN(size, node->allocSize));
+            _snzu_useMemPoolFree(&_snzu_instance->useMemPool, node->alloc, node->allocSize);
+            node->alloc = newAlloc;
+            node->allocSize = size;
+        }
+        _snzu_useMemMarkTouched(node);
+        _snzu_instance->useMemIsLastAllocTouchedNew = false;
+        return node->alloc;
     }
-    SNZ_ASSERT(firstFree != NULL, "use mem failed, no more free nodes.");
+
     // no node out there matches, we need to make a new one
-    memset(firstFree, 0, sizeof(*firstFree));
-    firstFree->inUse = true;
-    firstFree->pathHash = pathHash;
-    firstFree->allocSize = size;
-    firstFree->lastFrameTouched = _snzu_instance->currentFrameIdx;
-    firstFree->alloc = calloc(1, size);
-    SNZ_ASSERT(firstFree->alloc, "allocating new usemem alloc failed.");
+    if ((_snzu_instance->useMemLiveCount + 1) * 4 > _snzu_instance->useMemSlotCapacity * 3) {
+        _snzu_useMemResizeSlots(_snzu_instance->useMemSlotCapacity * 2);
+        slot = _snzu_useMemFindSlot(pathHash);
+    }
+    _snzu_useMemAllocNode* node = _snzu_useMemNewNode();
+    node->inUse = true;
+    node->pathHash = pathHash;
+    node->allocSize = size;
+    _snzu_useMemMarkTouched(node);
+    node->alloc = _snzu_useMemPoolAlloc(&_snzu_instance->useMemPool, size);
+    _snzu_instance->useMemSlots[slot] = (uint32_t)(node - _snzu_instance->useMemNodes) + 1;
+    _snzu_instance->useMemLiveCount++;
     _snzu_instance->useMemIsLastAllocTouchedNew = true;
-    return firstFree->alloc;
+    return node->alloc;
 }
 
 // returns whether the last returned call to snzu_useMem this frame was newly allocated or persisted
@@ -1089,18 +2893,24 @@ bool snzu_useMemIsPrevNew() {
     return _snzu_instance->useMemIsLastAllocTouchedNew;
 }
 
-// sets the in use flag on each useMem node that has not been touched on the current frame
+// retires each useMem node that has not been touched on the current frame
+// only nodes touched on the frame before are candidates, anything older was already retired
 static void _snzu_useMemClearOld() {
-    for (uint64_t i = 0; i < _SNZU_USEMEM_MAX_ALLOCS; i++) {
-        _snzu_useMemAllocNode* node = &_snzu_instance->useMemAllocs[i];
-        if (!node->inUse) {
-            continue;
-        }
+    _snzu_UseMemTouchedList* last = &_snzu_instance->useMemTouchedLastFrame;
+    for (uint64_t i = 0; i < last->count; i++) {
+        _snzu_useMemAllocNode* node = &_snzu_instance->useMemNodes[last->idxs[i]];
+        SNZ_ASSERT(node->inUse, "usemem touched list pointing at a dead node");
         SNZ_ASSERT(node->lastFrameTouched <= _snzu_instance->currentFrameIdx, "usemem node somehow more recent than frame");
         if (node->lastFrameTouched < _snzu_instance->currentFrameIdx) {
-            node->inUse = false;
+            _snzu_useMemRetire(last->idxs[i]);
         }
     }
+
+    // this frames list becomes last frames, and the old one gets reused
+    _snzu_UseMemTouchedList temp = *last;
+    *last = _snzu_instance->useMemTouchedThisFrame;
+    _snzu_instance->useMemTouchedThisFrame = temp;
+    _snzu_instance->useMemTouchedThisFrame.count = 0;
 }
 
 #define SNZU_USE_MEM(T, tag) ((T*)snzu_useMem(sizeof(T), (tag)))
@@ -1110,16 +2920,65 @@ snzu_Instance snzu_instanceInit() {
     return (snzu_Instance) { 0 };
 }
 
+// frees all useMem allocations, the instance shouldn't be used after this
+void snzu_instanceDeinit(snzu_Instance* instance) {
+    for (uint64_t i = 0; i < instance->useMemNodeCount; i++) {
+        _snzu_useMemAllocNode* node = &instance->useMemNodes[i];
+        if (node->inUse) {
+            _snzu_useMemPoolFree(&instance->useMemPool, node->alloc, node->allocSize);
+        }
+    }
+    _snzu_UseMemPoolChunk* chunk = instance->useMemPool.firstChunk;
+    while (chunk) {
+        _snzu_UseMemPoolChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(instance->useMemNodes);
+    free(instance->useMemSlots);
+    free(instance->useMemTouchedThisFrame.idxs);
+    free(instance->useMemTouchedLastFrame.idxs);
+    memset(instance, 0, sizeof(*instance));
+}
+
 void snzu_instanceSelect(snzu_Instance* instance) {
     _snzu_instance = instance;
 }
 
-// TODO: formatted version
-_snzu_Box* snzu_boxNew(const char* tag) {
+#ifndef NDEBUG
+// writes the tags from the root down to box into out, like 'main > margin > #1f3a...'
+// integer keyed boxes show up as their path hash
+static void _snzu_boxParentTrace(const _snzu_Box* box, char* out, uint64_t outSize) {
+    const _snzu_Box* chain[64];
+    int64_t chainCount = 0;
+    for (const _snzu_Box* b = box; b && b->parent && chainCount < 64; b = b->parent) {
+        chain[chainCount] = b;
+        chainCount++;
+    }
+
+    out[0] = '\0';
+    uint64_t used = 0;
+    for (int64_t i = chainCount - 1; i >= 0 && used < outSize; i--) {
+        const char* sep = (i == chainCount - 1) ? "" : " > ";
+        int written = 0;
+        if (chain[i]->tag) {
+            written = snprintf(out + used, outSize - used, "%s%s", sep, chain[i]->tag);
+        } else {
+            written = snprintf(out + used, outSize - used, "%s#%" PRIx64, sep, chain[i]->pathHash);
+        }
+        if (written < 0) {
+            break;
+        }
+        used += written;
+    }
+}
+#endif
+
+// tag is only kept for debugging, and is NULL for integer keyed boxes
+static _snzu_Box* _snzu_boxNewKeyed(const char* tag, uint64_t key) {
     SNZ_ASSERT(_snzu_instance->currentParentBox != NULL, "creating a new box, parent was null");
     _snzu_Box* b = SNZ_ARENA_PUSH(_snzu_instance->frameArena, _snzu_Box);
     b->tag = tag;
-    b->texture = _snzr_globs.solidTex;
 
     b->parent = _snzu_instance->currentParentBox;
     if (_snzu_instance->currentParentBox->lastChild) {
@@ -1132,24 +2991,50 @@ _snzu_Box* snzu_boxNew(const char* tag) {
     }
     _snzu_instance->selectedBox = b;
 
-    b->pathHash = _snzu_generatePathHash(b->parent->pathHash, tag);
-    for (_snzu_Box* sibling = b->parent->firstChild; sibling; sibling = sibling->nextSibling) {
-        if (sibling == b) {
-            continue;
-        } else if (sibling->pathHash == b->pathHash) {
-            // FIXME: would be nice to have a parent trace
-            SNZ_ASSERTF(false, "could not make new box, tag '%s' was already used in parent.\n", tag);
+    b->pathHash = _snzu_hashCombine(b->parent->pathHash, key);
+    bool isNew = false;
+    *SNZ_HASH_MAP_GET_OR_INSERT(_snzu_BoxIndex, &_snzu_instance->boxesByPathHash, b->pathHash, &isNew) = b;
+#ifndef NDEBUG
+    // path hashes include the parents, so a repeat anywhere in the frame means a repeat among siblings
+    if (!isNew) {
+        char trace[512];
+        _snzu_boxParentTrace(b->parent, trace, sizeof(trace));
+        if (tag) {
+            SNZ_ASSERTF(false, "could not make new box, tag '%s' was already used in parent.\nparent trace: %s\n", tag, trace);
+        } else {
+            SNZ_ASSERTF(false, "could not make new box, key %" PRIu64 " was already used in parent.\nparent trace: %s\n", key, trace);
         }
     }
+#else
+    (void)isNew;
+#endif
 
     return b;
 }
 
+// tag must be unique among siblings
+_snzu_Box* snzu_boxNew(const char* tag) {
+    return _snzu_boxNewKeyed(tag, _snz_hashBytes(tag, strlen(tag)));
+}
+
+// same as snzu_boxNew but keyed on an integer, so nothing needs to be formatted into a tag
+// key must be unique among siblings
+_snzu_Box* snzu_boxNewU64(uint64_t key) {
+    return _snzu_boxNewKeyed(NULL, key);
+}
+
+// keyed on the pointer value, for boxes that represent some persistent object
+_snzu_Box* snzu_boxNewPtr(const void* ptr) {
+    return _snzu_boxNewKeyed(NULL, (uint64_t)(uintptr_t)ptr ^ _SNZU_PTR_KEY_SALT);
+}
+
 // preps for a new frame with the currently selected instance
 // entire tree's parent does not clip children, but is initialized to be parentSize
 // doesn't do any rendering and is not reliant on anything being ready besides a selected ui instance
 void snzu_frameStart(snz_Arena* frameArena, HMM_Vec2 parentSize, float dt) {
     _snzu_instance->frameArena = frameArena;
+    _snzu_instance->boxesByPathHash = SNZ_HASH_MAP_INIT(_snzu_BoxIndex, frameArena, 0);
+    _snzu_instance->interactiveBoxes = SNZ_DYNARR_INIT(_snzu_BoxPtrDynArr, frameArena, 0);
 
     _snzu_useMemClearOld();
     _snzu_instance->useMemIsLastAllocTouchedNew = false;
@@ -1161,85 +3046,264 @@ void snzu_frameStart(snz_Arena* frameArena, HMM_Vec2 parentSize, float dt) {
     _snzu_instance->treeParent.pathHash = 6969420;
     _snzu_instance->currentParentBox = &_snzu_instance->treeParent;
     _snzu_instance->currentParentBox->end = parentSize;
+    _snzu_instance->selectedBox = _snzu_instance->currentParentBox;  // last frames boxes are gone
+}
+
+// NULL if no box with that hash was made this frame
+static _snzu_Box* _snzu_findBoxByPathHash(uint64_t pathHash) {
+    _snzu_Box** found = _snzu_BoxIndex_get(&_snzu_instance->boxesByPathHash, pathHash);
+    return found ? *found : NULL;
+}
+
+// false when the rect has no area in common with the clip, touching edges don't count
+static bool _snzu_rectOverlapsClip(HMM_Vec2 start, HMM_Vec2 end, HMM_Vec2 clipStart, HMM_Vec2 clipEnd) {
+    return start.X < clipEnd.X && end.X > clipStart.X &&
+           start.Y < clipEnd.Y && end.Y > clipStart.Y;
 }
 
-static _snzu_Box* _snzu_findBoxByPathHash(uint64_t pathHash, _snzu_Box* parent) {
-    if (parent->pathHash == pathHash) {
-        return parent;
+// shrinks the clip so that it doesn't go outside of box
+static void _snzu_clipToBox(const _snzu_Box* box, HMM_Vec2* clipStart, HMM_Vec2* clipEnd) {
+    if (clipStart->X < box->start.X) {
+        clipStart->X = box->start.X;
+    }
+    if (clipEnd->X > box->end.X) {
+        clipEnd->X = box->end.X;
+    }
+    if (clipStart->Y < box->start.Y) {
+        clipStart->Y = box->start.Y;
+    }
+    if (clipEnd->Y > box->end.Y) {
+        clipEnd->Y = box->end.Y;
     }
+}
 
-    for (_snzu_Box* child = parent->firstChild; child; child = child->nextSibling) {
-        _snzu_Box* found = _snzu_findBoxByPathHash(pathHash, child);
-        if (found != NULL) {
-            return found;
+// draws the rect and text of a single box, coords should already be resolved
+static void _snzu_drawBoxContents(const _snzu_Box* box, HMM_Vec2 clipStart, HMM_Vec2 clipEnd, HMM_Mat4 vp) {
+    snzu_FrameStats* stats = &_snzu_instance->frameStats;
+
+    const _snzu_BoxStyle* style = box->style;
+    bool drawRect = style != NULL;
+    if (drawRect) {
+        bool hasArea = box->end.X > box->start.X && box->end.Y > box->start.Y;
+        bool visibleBorder = style->borderThickness > 0 && style->borderColor.A > 0;
+        if (!hasArea || (style->color.A <= 0 && !visibleBorder)) {
+            drawRect = false;
+            stats->culledInvisible++;
+        } else if (!_snzu_rectOverlapsClip(box->start, box->end, clipStart, clipEnd)) {
+            drawRect = false;
+            stats->culledClipped++;
         }
     }
+    if (drawRect) {
+        stats->rectsDrawn++;
+        snzr_drawRect(
+            box->start, box->end,
+            clipStart, clipEnd,
+            style->color,
+            style->cornerRadius,
+            style->borderThickness, style->borderColor,
+            vp,
+            style->texture);
+    }
 
-    return NULL;
+    _snzu_BoxText* text = box->text;
+    if (text && text->str != NULL) {
+        HMM_Vec2 textPos = HMM_DivV2F(HMM_AddV2(box->start, box->end), 2);  // set to the midpoint of the box
+        HMM_Vec2 textSize = _snzu_boxTextSize(text);
+        textPos = HMM_SubV2(textPos, HMM_DivV2F(textSize, 2));
+        if (!_snzu_rectOverlapsClip(textPos, HMM_AddV2(textPos, textSize), clipStart, clipEnd)) {
+            stats->culledClipped++;
+        } else {
+            stats->textsDrawn++;
+            float scaleFactor = (text->renderedHeight / text->font->renderedSize);
+            textPos.Y += text->font->ascent * scaleFactor;
+            snzr_drawTextScaled(
+                textPos,
+                clipStart, clipEnd,
+                text->color,
+                text->str, text->len,
+                *text->font,
+                vp,
+                text->renderedHeight,
+                !text->removeSnap);
+        }
+    }
 }
 
-static void _snzu_drawBoxAndChildren(_snzu_Box* parent, HMM_Vec2 clipStart, HMM_Vec2 clipEnd, HMM_Mat4 vp) {
-    HMM_Vec2 newClipStart = clipStart;
-    HMM_Vec2 newClipEnd = clipEnd;
-    if (newClipStart.X < parent->start.X) {
-        newClipStart.X = parent->start.X;
+// where boxes are being drawn to, either the screen or the frame buffer of a cached box
+typedef struct {
+    uint32_t frameBufferId;  // 0 for the screen
+    int32_t width;
+    int32_t height;
+} _snzu_DrawTarget;
+
+// frame buffers of cached boxes hold premultiplied color, so their alpha gets blended differently
+static void _snzu_drawTargetSetBlend(_snzu_DrawTarget target) {
+    if (target.frameBufferId) {
+        snzr_callGLFnOrError(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+    } else {
+        snzr_callGLFnOrError(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    }
+}
+
+static void _snzu_drawTargetBind(_snzu_DrawTarget target) {
+    snzr_callGLFnOrError(glBindFramebuffer(GL_FRAMEBUFFER, target.frameBufferId));
+    snzr_callGLFnOrError(glViewport(0, 0, target.width, target.height));
+    _snzu_drawTargetSetBlend(target);
+}
+
+static void _snzu_boxCacheDraw(_snzu_Box* box, HMM_Vec2 clipStart, HMM_Vec2 clipEnd, HMM_Mat4 vp, _snzu_DrawTarget target);
+
+// draws a subtree that has already been resolved by _snzu_resolveBoxAndChildren
+static void _snzu_drawBoxAndChildren(_snzu_Box* box, HMM_Vec2 clipStart, HMM_Vec2 clipEnd, HMM_Mat4 vp, _snzu_DrawTarget target) {
+    if (box->clipChildren) {
+        _snzu_clipToBox(box, &clipStart, &clipEnd);
+    }
+    // children only ever get a smaller clip, so once it's empty nothing below here can draw.
+    // a clipping box entirely outside of the clip always ends up here, other boxes can't be skipped
+    // just for being outside because their children are allowed to be somewhere else
+    if (clipStart.X >= clipEnd.X || clipStart.Y >= clipEnd.Y) {
+        return;
+    }
+    _snzu_drawBoxContents(box, clipStart, clipEnd, vp);
+
+    if (box->cache) {
+        _snzu_boxCacheDraw(box, clipStart, clipEnd, vp, target);
+        return;
+    }
+    for (_snzu_Box* child = box->firstChild; child; child = child->nextSibling) {
+        _snzu_drawBoxAndChildren(child, clipStart, clipEnd, vp, target);
+    }
+}
+
+// draws the children of a cached box onto target as one textured rect, drawing them into the boxes frame buffer
+// first if its key or size changed. The children should already be resolved, and clipStart/End should be the
+// clip that they would have been drawn with.
+// the frame buffer is in the same pixel space as vp, just moved so that the corner of the box is at 00
+static void _snzu_boxCacheDraw(_snzu_Box* box, HMM_Vec2 clipStart, HMM_Vec2 clipEnd, HMM_Mat4 vp, _snzu_DrawTarget target) {
+    _snzu_BoxCache* cache = box->cache;
+    snzu_FrameStats* stats = &_snzu_instance->frameStats;
+
+    // snapped out to whole pixels so that the texture lands on the target 1:1
+    HMM_Vec2 start = HMM_V2(floorf(box->start.X), floorf(box->start.Y));
+    HMM_Vec2 end = HMM_V2(ceilf(box->end.X), ceilf(box->end.Y));
+    if (!_snzu_rectOverlapsClip(start, end, clipStart, clipEnd)) {
+        return;  // also catches boxes with no area, the old contents get kept for when it comes back
+    }
+    int32_t width = (int32_t)(end.X - start.X);
+    int32_t height = (int32_t)(end.Y - start.Y);
+    uint64_t key = snz_hashCombine(cache->key, ((uint64_t)(uint32_t)width << 32) | (uint32_t)height);
+
+    snzr_FrameBuffer* fb = &cache->frameBuffer;
+    bool sizeChanged = fb->texture.width != (uint32_t)width || fb->texture.height != (uint32_t)height;
+    if (sizeChanged || key != cache->renderedKey) {
+        stats->cachesRedrawn++;
+        snzr_flush();  // anything pending belongs on the target being left
+        if (sizeChanged) {
+            if (fb->glId) {
+                snzr_frameBufferDeinit(fb);
+            }
+            *fb = snzr_frameBufferInit(snzr_textureInitRBGA(width, height, NULL));
+        }
+
+        _snzu_DrawTarget cacheTarget = { .frameBufferId = fb->glId, .width = width, .height = height };
+        _snzu_drawTargetBind(cacheTarget);
+        snzr_callGLFnOrError(glClearColor(0, 0, 0, 0));
+        snzr_callGLFnOrError(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+
+        // FIXME: near and far are assumed to match vp
+        HMM_Mat4 cacheVP = HMM_Orthographic_RH_NO(start.X, end.X, end.Y, start.Y, 0, 10000);
+        for (_snzu_Box* child = box->firstChild; child; child = child->nextSibling) {
+            _snzu_drawBoxAndChildren(child, start, end, cacheVP, cacheTarget);
+        }
+        snzr_flush();
+        _snzu_drawTargetBind(target);
+        cache->renderedKey = key;
+    } else {
+        stats->cachesReused++;
+    }
+
+    snzr_flush();
+    snzr_callGLFnOrError(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+    snzr_drawRect(start, end, clipStart, clipEnd, HMM_V4(1, 1, 1, 1), 0, 0, HMM_V4(0, 0, 0, 0), vp, fb->texture);
+    snzr_flush();
+    _snzu_drawTargetSetBlend(target);
+}
+
+// mixes everything that _snzu_drawBoxContents would draw for box into h
+static uint64_t _snzu_hashBoxContents(uint64_t h, const _snzu_Box* box, HMM_Vec2 clipStart, HMM_Vec2 clipEnd) {
+    const _snzu_BoxStyle* style = box->style;
+    const _snzu_BoxText* text = box->text;
+    if (text && text->str == NULL) {
+        text = NULL;
     }
-    if (newClipEnd.X > parent->end.X) {
-        newClipEnd.X = parent->end.X;
+    if (!style && !text) {
+        return h;
     }
-    if (newClipStart.Y < parent->start.Y) {
-        newClipStart.Y = parent->start.Y;
+
+    float geometry[] = {
+        box->start.X, box->start.Y, box->end.X, box->end.Y,
+        clipStart.X, clipStart.Y, clipEnd.X, clipEnd.Y,
+    };
+    h = snz_hashCombine(h, _snz_hashBytes(geometry, sizeof(geometry)));
+    if (style) {
+        float props[] = {
+            style->color.X, style->color.Y, style->color.Z, style->color.W,
+            style->borderColor.X, style->borderColor.Y, style->borderColor.Z, style->borderColor.W,
+            style->cornerRadius, style->borderThickness,
+        };
+        h = snz_hashCombine(h, _snz_hashBytes(props, sizeof(props)));
+        h = snz_hashCombine(h, style->texture.glId);
     }
-    if (newClipEnd.Y > parent->end.Y) {
-        newClipEnd.Y = parent->end.Y;
+    if (text) {
+        float props[] = { text->color.X, text->color.Y, text->color.Z, text->color.W, text->renderedHeight };
+        h = snz_hashCombine(h, _snz_hashBytes(props, sizeof(props)));
+        h = snz_hashCombine(h, _snz_hashBytes(text->str, text->len));
+        h = snz_hashCombine(h, (uint64_t)(uintptr_t)text->font ^ text->removeSnap);
     }
+    return h;
+}
+
+// offset is the sum of all pending childOffsets above parent, applied here so that every box ends the
+// frame with absolute coords. Everything gets resolved and registered for interactions, even boxes that
+// won't be drawn, so that anything reading them (like an interaction that was hovered last frame) sees
+// them correctly.
+// what would be drawn gets mixed into drawHash, so that unchanged frames can skip drawing entirely
+// clipStart/End may be an empty rect, which means nothing below can be seen
+static void _snzu_resolveBoxAndChildren(_snzu_Box* parent, HMM_Vec2 offset, HMM_Vec2 clipStart, HMM_Vec2 clipEnd, uint64_t* drawHash) {
+    _snzu_instance->frameStats.boxes++;
+
+    parent->start = HMM_AddV2(parent->start, offset);
+    parent->end = HMM_AddV2(parent->end, offset);
+    HMM_Vec2 childOffset = HMM_AddV2(offset, parent->childOffset);
+    parent->childOffset = HMM_V2(0, 0);
+
+    HMM_Vec2 newClipStart = clipStart;
+    HMM_Vec2 newClipEnd = clipEnd;
+    _snzu_clipToBox(parent, &newClipStart, &newClipEnd);
 
     // always forward a clip to the parents clipped rect, because it's used for processing
     // inputs and shouldn't be larger than the parent. Only apply the change to children
     // if the clipChildren flag is set
     parent->clippedStart = newClipStart;
     parent->clippedEnd = newClipEnd;
+    if (parent->interactionMask || parent->interactionTarget) {
+        *SNZ_DYNARR_PUSH(_snzu_BoxPtrDynArr, &_snzu_instance->interactiveBoxes) = parent;
+    }
     if (parent->clipChildren) {
         clipStart = newClipStart;
         clipEnd = newClipEnd;
     }
 
-    snzr_drawRect(
-        parent->start, parent->end,
-        clipStart, clipEnd,
-        parent->color,
-        parent->cornerRadius,
-        parent->borderThickness, parent->borderColor,
-        vp,
-        parent->texture);
-
-    if (parent->displayStr != NULL) {
-        HMM_Vec2 textPos = HMM_DivV2F(HMM_AddV2(parent->start, parent->end), 2);  // set to the midpoint of the box
-        HMM_Vec2 textSize = snzr_strSize(parent->font, parent->displayStr, parent->displayStrLen, parent->displayStrRenderedHeight);
-        textPos = HMM_SubV2(textPos, HMM_DivV2F(textSize, 2));
-        float scaleFactor = (parent->displayStrRenderedHeight / parent->font->renderedSize);
-        textPos.Y += parent->font->ascent * scaleFactor;
-        snzr_drawTextScaled(
-            textPos,
-            clipStart, clipEnd,
-            parent->displayStrColor,
-            parent->displayStr, parent->displayStrLen,
-            *parent->font,
-            vp,
-            parent->displayStrRenderedHeight,
-            !parent->displayStrRemoveSnap);
-    }
-
+    *drawHash = _snzu_hashBoxContents(*drawHash, parent, clipStart, clipEnd);
     for (_snzu_Box* child = parent->firstChild; child; child = child->nextSibling) {
-        _snzu_drawBoxAndChildren(child, clipStart, clipEnd, vp);
+        _snzu_resolveBoxAndChildren(child, childOffset, clipStart, clipEnd, drawHash);
     }
 }
 
-static void _snzu_genInteractionsForBoxAndChildren(_snzu_Box* box, uint64_t* remainingInteractionFlags) {
-    for (_snzu_Box* child = box->lastChild; child; child = child->prevSibling) {
-        _snzu_genInteractionsForBoxAndChildren(child, remainingInteractionFlags);
-    }
-
+// boxes should be given in reverse draw order, so things on top get the first chance at events
+// boxes with no mask and no target never do anything here, so they don't need to be passed in
+static void _snzu_genInteractionsForBox(_snzu_Box* box, uint64_t* remainingInteractionFlags) {
     if (box->interactionTarget) {
         snzu_Interaction* inter = box->interactionTarget;
 
@@ -1333,7 +3397,36 @@ static void _snzu_genInteractionsForBoxAndChildren(_snzu_Box* box, uint64_t* rem
 void snzu_frameDrawAndGenInteractions(snzu_Input input, HMM_Mat4 vp) {
     _snzu_instance->currentInputs = input;
 
-    _snzu_drawBoxAndChildren(&_snzu_instance->treeParent, HMM_V2(-INFINITY, -INFINITY), HMM_V2(INFINITY, INFINITY), vp);
+    _snzu_instance->frameStats = (snzu_FrameStats){ 0 };
+    HMM_Vec2 noClipStart = HMM_V2(-INFINITY, -INFINITY);
+    HMM_Vec2 noClipEnd = HMM_V2(INFINITY, INFINITY);
+    _SNZ_PROFILE_BEGIN(SNZ_PROFILE_PHASE_LAYOUT);
+    uint64_t drawHash = _snz_hashBytes(&vp, sizeof(vp));
+    _snzu_resolveBoxAndChildren(&_snzu_instance->treeParent, HMM_V2(0, 0), noClipStart, noClipEnd, &drawHash);
+    _SNZ_PROFILE_COUNT(boxes, _snzu_instance->frameStats.boxes);
+    _SNZ_PROFILE_END(SNZ_PROFILE_PHASE_LAYOUT);
+
+    // skipping is only safe when the last thing this instance drew is still what's on screen,
+    // which is only known when snz_main is keeping track of the damage state
+    bool canSkip = !_snzu_damage.forceRedraw && _snzu_damage.instancesDrawnLastFrame <= 1;
+    _snzu_damage.instancesDrawn++;
+    if (canSkip && drawHash == _snzu_instance->lastDrawHash) {
+        _snzu_instance->frameStats.drawSkipped = true;
+        _snzu_damage.instancesSkipped++;
+    } else {
+        _SNZ_PROFILE_BEGIN(SNZ_PROFILE_PHASE_DRAW);
+        _snzu_DrawTarget screen = {
+            .frameBufferId = 0,
+            .width = (int32_t)_snzr_globs.screenSize.X,
+            .height = (int32_t)_snzr_globs.screenSize.Y,
+        };
+        _snzu_drawBoxAndChildren(&_snzu_instance->treeParent, noClipStart, noClipEnd, vp, screen);
+        snzr_flush();  // so that anything the caller draws after this lands on top
+        _snzu_instance->lastDrawHash = drawHash;
+        _SNZ_PROFILE_END(SNZ_PROFILE_PHASE_DRAW);
+    }
+
+    _SNZ_PROFILE_BEGIN(SNZ_PROFILE_PHASE_INTERACTIONS);
 
     // compute mouse actions for this frame
     bool wasMouseUp = false;
@@ -1357,10 +3450,13 @@ void snzu_frameDrawAndGenInteractions(snzu_Input input, HMM_Mat4 vp) {
     }
 
     uint64_t interactionFlags = ~SNZU_IF_NONE;
-    _snzu_genInteractionsForBoxAndChildren(&_snzu_instance->treeParent, &interactionFlags);
+    _snzu_BoxPtrDynArr* interactive = &_snzu_instance->interactiveBoxes;
+    for (int64_t i = interactive->count - 1; i >= 0; i--) {
+        _snzu_genInteractionsForBox(interactive->elems[i], &interactionFlags);
+    }
 
     if (_snzu_instance->mouseCapturePathHash != 0) {
-        _snzu_Box* box = _snzu_findBoxByPathHash(_snzu_instance->mouseCapturePathHash, &_snzu_instance->treeParent);
+        _snzu_Box* box = _snzu_findBoxByPathHash(_snzu_instance->mouseCapturePathHash);
         if (box != NULL) {
             snzu_Interaction* inter = box->interactionTarget;
             if (inter != NULL) {
@@ -1381,6 +3477,12 @@ void snzu_frameDrawAndGenInteractions(snzu_Input input, HMM_Mat4 vp) {
         _snzu_instance->mouseCapturePathHash = 0;  // RMB clears this focus, which can fuck up a LMB drag, it doesn't get cleared on mouseup bc 'nothing is dragged'
     }
     _snzu_instance->previousInputs = _snzu_instance->currentInputs;
+    _SNZ_PROFILE_END(SNZ_PROFILE_PHASE_INTERACTIONS);
+}
+
+// counts from the last time the selected instance was drawn
+snzu_FrameStats snzu_getFrameStats() {
+    return _snzu_instance->frameStats;
 }
 
 void snzu_boxEnter() {
@@ -1437,32 +3539,84 @@ void snzu_boxClipChildren(bool shouldClip) {
     _snzu_instance->selectedBox->clipChildren = shouldClip;
 }
 
+// draws the children of the selected box into an offscreen texture and reuses it on later frames for as long as
+// contentHash, the size of the box, and anything mixed in while building the children stay the same.
+// scroll areas and snzu_ease* calls under the box mix in their values automatically, anything else that
+// changes what the children look like needs to go into contentHash.
+// children still get built, laid out, and interacted with every frame, only drawing them gets skipped.
+// call before building any children. The box will clip its children, and its own rect and text get drawn normally.
+// assumes the vp given to snzu_frameDrawAndGenInteractions is in pixels with 00 in the UL corner.
+// FIXME: the frame buffer is never freed if the box stops being built
+void snzu_boxSetCached(uint64_t contentHash) {
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    box->cache = SNZU_USE_MEM(_snzu_BoxCache, "snzuBoxCache");
+    box->cache->key = contentHash;
+    box->clipChildren = true;
+}
+
+// mixes v into the key of every cached box above the selected one (and the selected one)
+static void _snzu_boxCacheMix(uint64_t v) {
+    for (_snzu_Box* box = _snzu_instance->selectedBox; box; box = box->parent) {
+        if (box->cache) {
+            box->cache->key = snz_hashCombine(box->cache->key, v);
+        }
+    }
+}
+
+static void _snzu_boxCacheMixFloat(float f) {
+    uint32_t bits = 0;
+    memcpy(&bits, &f, sizeof(bits));
+    _snzu_boxCacheMix(bits);
+}
+
+// pushes the selected box's style into the frame arena if it doesn't have one yet
+static _snzu_BoxStyle* _snzu_boxGetStyle() {
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    if (!box->style) {
+        box->style = SNZ_ARENA_PUSH(_snzu_instance->frameArena, _snzu_BoxStyle);
+        box->style->texture = _snzr_globs.solidTex;
+    }
+    return box->style;
+}
+
+static _snzu_BoxText* _snzu_boxGetText() {
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    if (!box->text) {
+        box->text = SNZ_ARENA_PUSH(_snzu_instance->frameArena, _snzu_BoxText);
+    }
+    return box->text;
+}
+
 void snzu_boxSetColor(HMM_Vec4 color) {
-    _snzu_instance->selectedBox->color = color;
+    _snzu_boxGetStyle()->color = color;
 }
 
 void snzu_boxSetCornerRadius(float radiusPx) {
-    _snzu_instance->selectedBox->cornerRadius = radiusPx;
+    _snzu_boxGetStyle()->cornerRadius = radiusPx;
 }
 
 void snzu_boxSetBorder(float px, HMM_Vec4 col) {
-    _snzu_instance->selectedBox->borderThickness = px;
-    _snzu_instance->selectedBox->borderColor = col;
+    _snzu_BoxStyle* style = _snzu_boxGetStyle();
+    style->borderThickness = px;
+    style->borderColor = col;
 }
 
 void snzu_boxSetTexture(snzr_Texture texture) {
-    _snzu_instance->selectedBox->color = HMM_V4(1, 1, 1, 1);
-    _snzu_instance->selectedBox->texture = texture;
+    _snzu_BoxStyle* style = _snzu_boxGetStyle();
+    style->color = HMM_V4(1, 1, 1, 1);
+    style->texture = texture;
 }
 
 // string should last until the end of the frome
 // font must also last
 void snzu_boxSetDisplayStrLen(const snzr_Font* font, HMM_Vec4 color, const char* str, uint64_t strLen) {
-    _snzu_instance->selectedBox->font = font;
-    _snzu_instance->selectedBox->displayStrColor = color;
-    _snzu_instance->selectedBox->displayStr = str;
-    _snzu_instance->selectedBox->displayStrLen = strLen;
-    _snzu_instance->selectedBox->displayStrRenderedHeight = font->renderedSize;
+    _snzu_BoxText* text = _snzu_boxGetText();
+    text->font = font;
+    text->color = color;
+    text->str = str;
+    text->len = strLen;
+    text->renderedHeight = font->renderedSize;
+    text->sizeValid = false;
 }
 
 // str is null terminated, must last until the end of the frame
@@ -1472,44 +3626,90 @@ void snzu_boxSetDisplayStr(const snzr_Font* font, HMM_Vec4 color, const char* st
 }
 
 void snzu_boxSetDisplayStrMode(float height, bool removeSnap) {
-    _snzu_instance->selectedBox->displayStrRenderedHeight = height;
-    _snzu_instance->selectedBox->displayStrRemoveSnap = removeSnap;
+    _snzu_BoxText* text = _snzu_boxGetText();
+    text->renderedHeight = height;
+    text->removeSnap = removeSnap;
+    text->sizeValid = false;
+}
+
+// LAYOUT:
+// moving a box with all of its children only touches that box, the move is stored in its childOffset
+// and pushed down to the children when the frame is drawn. That means a box's stored coords are off by
+// the sum of its ancestors childOffsets (see _snzu_boxPendingOffset). Siblings share that, so they can
+// be compared directly, and a parents coords get into the same space as its children by subtracting
+// the parents childOffset.
+
+// sum of moves made to ancestors of box that haven't reached it yet, walks up the tree
+static HMM_Vec2 _snzu_boxPendingOffset(const _snzu_Box* box) {
+    HMM_Vec2 out = HMM_V2(0, 0);
+    for (const _snzu_Box* p = box->parent; p; p = p->parent) {
+        out = HMM_AddV2(out, p->childOffset);
+    }
+    return out;
+}
+
+static HMM_Vec2 _snzu_boxAbsStart(const _snzu_Box* box) {
+    return HMM_AddV2(box->start, _snzu_boxPendingOffset(box));
+}
+
+static HMM_Vec2 _snzu_boxAbsEnd(const _snzu_Box* box) {
+    return HMM_AddV2(box->end, _snzu_boxPendingOffset(box));
+}
+
+// parents start/end in the same space as the stored coords of its children
+static HMM_Vec2 _snzu_boxParentStart(const _snzu_Box* box) {
+    return HMM_SubV2(box->parent->start, box->parent->childOffset);
+}
+
+static HMM_Vec2 _snzu_boxParentEnd(const _snzu_Box* box) {
+    return HMM_SubV2(box->parent->end, box->parent->childOffset);
+}
+
+// moves box and everything inside it by diff, O(1)
+static void _snzu_boxMoveRecurse(_snzu_Box* box, HMM_Vec2 diff) {
+    box->start = HMM_AddV2(box->start, diff);
+    box->end = HMM_AddV2(box->end, diff);
+    box->childOffset = HMM_AddV2(box->childOffset, diff);
 }
 
 void snzu_boxSetStart(HMM_Vec2 newStart) {
-    _snzu_instance->selectedBox->start = newStart;
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    box->start = HMM_SubV2(newStart, _snzu_boxPendingOffset(box));
 }
 
 void snzu_boxSetStartFromParentStart(HMM_Vec2 offset) {
-    HMM_Vec2 finalPos = HMM_AddV2(_snzu_instance->selectedBox->parent->start, offset);
+    HMM_Vec2 finalPos = HMM_AddV2(_snzu_boxParentStart(_snzu_instance->selectedBox), offset);
     _snzu_instance->selectedBox->start = finalPos;
 }
 
 void snzu_boxSetStartAx(float newStart, snzu_Axis ax) {
-    _snzu_instance->selectedBox->start.Elements[ax] = newStart;
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    box->start.Elements[ax] = newStart - _snzu_boxPendingOffset(box).Elements[ax];
 }
 
 void snzu_boxSetStartFromParentAx(float offset, snzu_Axis ax) {
-    float finalPos = _snzu_instance->selectedBox->parent->start.Elements[ax] + offset;
+    float finalPos = _snzu_boxParentStart(_snzu_instance->selectedBox).Elements[ax] + offset;
     _snzu_instance->selectedBox->start.Elements[ax] = finalPos;
 }
 
 void snzu_boxSetEnd(HMM_Vec2 newEnd) {
-    _snzu_instance->selectedBox->end = newEnd;
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    box->end = HMM_SubV2(newEnd, _snzu_boxPendingOffset(box));
 }
 
 void snzu_boxSetEndFromParentEnd(HMM_Vec2 offset) {
-    HMM_Vec2 finalPos = HMM_AddV2(_snzu_instance->selectedBox->parent->end, offset);
+    HMM_Vec2 finalPos = HMM_AddV2(_snzu_boxParentEnd(_snzu_instance->selectedBox), offset);
     _snzu_instance->selectedBox->end = finalPos;
 }
 
 void snzu_boxSetEndFromParentEndAx(float offset, snzu_Axis ax) {
-    float finalPos = _snzu_instance->selectedBox->parent->end.Elements[ax] + offset;
+    float finalPos = _snzu_boxParentEnd(_snzu_instance->selectedBox).Elements[ax] + offset;
     _snzu_instance->selectedBox->end.Elements[ax] = finalPos;
 }
 
 void snzu_boxSetEndAx(float newEnd, snzu_Axis ax) {
-    _snzu_instance->selectedBox->end.Elements[ax] = newEnd;
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    box->end.Elements[ax] = newEnd - _snzu_boxPendingOffset(box).Elements[ax];
 }
 
 void snzu_boxSetSizeFromStart(HMM_Vec2 newSize) {
@@ -1537,44 +3737,37 @@ HMM_Vec2 snzu_boxGetSize() {
     return snzu_boxGetSizePtr(_snzu_instance->selectedBox);
 }
 
-static void _snzu_boxSetStartKeepSizeRecurse(_snzu_Box* box, HMM_Vec2 diff) {
-    box->start = HMM_AddV2(box->start, diff);
-    box->end = HMM_AddV2(box->end, diff);
-    for (_snzu_Box* child = box->firstChild; child; child = child->nextSibling) {
-        _snzu_boxSetStartKeepSizeRecurse(child, diff);
-    }
-}
-
+// newStart is absolute
 void snzu_boxSetStartKeepSizeRecursePtr(_snzu_Box* box, HMM_Vec2 newStart) {
-    HMM_Vec2 diff = HMM_SubV2(newStart, box->start);
-    _snzu_boxSetStartKeepSizeRecurse(box, diff);
+    HMM_Vec2 diff = HMM_SubV2(newStart, _snzu_boxAbsStart(box));
+    _snzu_boxMoveRecurse(box, diff);
 }
 
-// TODO: are there bad perf implications for this??
-// also moves all children
+// also moves all children, doesn't touch them until the frame is drawn tho
 void snzu_boxSetStartKeepSizeRecurse(HMM_Vec2 newStart) {
     snzu_boxSetStartKeepSizeRecursePtr(_snzu_instance->selectedBox, newStart);
 }
 
 void snzu_boxSetStartFromParentKeepSizeRecurse(HMM_Vec2 offset) {
-    HMM_Vec2 final = HMM_AddV2(offset, _snzu_instance->selectedBox->parent->start);
-    snzu_boxSetStartKeepSizeRecursePtr(_snzu_instance->selectedBox, final);
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    HMM_Vec2 final = HMM_AddV2(offset, _snzu_boxParentStart(box));
+    _snzu_boxMoveRecurse(box, HMM_SubV2(final, box->start));
 }
 
 // margin in pixels
 void snzu_boxSetSizeMarginFromParent(float m) {
-    _snzu_instance->selectedBox->start = HMM_Add(_snzu_instance->selectedBox->parent->start, HMM_V2(m, m));
-    _snzu_instance->selectedBox->end = HMM_Sub(_snzu_instance->selectedBox->parent->end, HMM_V2(m, m));
+    _snzu_instance->selectedBox->start = HMM_Add(_snzu_boxParentStart(_snzu_instance->selectedBox), HMM_V2(m, m));
+    _snzu_instance->selectedBox->end = HMM_Sub(_snzu_boxParentEnd(_snzu_instance->selectedBox), HMM_V2(m, m));
 }
 
 void snzu_boxSetSizeMarginFromParentAx(float px, snzu_Axis axis) {
-    _snzu_instance->selectedBox->start.Elements[axis] = _snzu_instance->selectedBox->parent->start.Elements[axis] + px;
-    _snzu_instance->selectedBox->end.Elements[axis] = _snzu_instance->selectedBox->parent->end.Elements[axis] - px;
+    _snzu_instance->selectedBox->start.Elements[axis] = _snzu_boxParentStart(_snzu_instance->selectedBox).Elements[axis] + px;
+    _snzu_instance->selectedBox->end.Elements[axis] = _snzu_boxParentEnd(_snzu_instance->selectedBox).Elements[axis] - px;
 }
 
 void snzu_boxFillParent() {
-    _snzu_instance->selectedBox->start = _snzu_instance->selectedBox->parent->start;
-    _snzu_instance->selectedBox->end = _snzu_instance->selectedBox->parent->end;
+    _snzu_instance->selectedBox->start = _snzu_boxParentStart(_snzu_instance->selectedBox);
+    _snzu_instance->selectedBox->end = _snzu_boxParentEnd(_snzu_instance->selectedBox);
 }
 
 // FIXME: setSize
@@ -1591,8 +3784,8 @@ void snzu_boxSizeFromEndPctParent(float pct, snzu_Axis ax) {
 // TODO: unit test this
 // maintains size but moves the box to be centered with other along ax
 void snzu_boxCenter(_snzu_Box* other, snzu_Axis ax) {
-    float boxCenter = (_snzu_instance->selectedBox->start.Elements[ax] + _snzu_instance->selectedBox->end.Elements[ax]) / 2.0f;
-    float otherCenter = (other->start.Elements[ax] + other->end.Elements[ax]) / 2.0f;
+    float boxCenter = (_snzu_boxAbsStart(_snzu_instance->selectedBox).Elements[ax] + _snzu_boxAbsEnd(_snzu_instance->selectedBox).Elements[ax]) / 2.0f;
+    float otherCenter = (_snzu_boxAbsStart(other).Elements[ax] + _snzu_boxAbsEnd(other).Elements[ax]) / 2.0f;
     float diff = otherCenter - boxCenter;
     _snzu_instance->selectedBox->start.Elements[ax] += diff;
     _snzu_instance->selectedBox->end.Elements[ax] += diff;
@@ -1605,12 +3798,12 @@ void snzu_boxAlignOuter(_snzu_Box* other, snzu_Axis ax, snzu_Align align) {
 
     float sidePos = 0;
     if (align == SNZU_ALIGN_MIN) {
-        sidePos = other->start.Elements[ax];
-        _snzu_instance->selectedBox->end.Elements[ax] = sidePos;
+        sidePos = _snzu_boxAbsStart(other).Elements[ax];
+        snzu_boxSetEndAx(sidePos, ax);
         snzu_boxSetSizeFromEnd(boxSize);
     } else if (SNZU_ALIGN_MAX) {
-        sidePos = other->end.Elements[ax];
-        _snzu_instance->selectedBox->start.Elements[ax] = sidePos;
+        sidePos = _snzu_boxAbsEnd(other).Elements[ax];
+        snzu_boxSetStartAx(sidePos, ax);
         snzu_boxSetSizeFromStart(boxSize);
     } else {
         SNZ_ASSERTF(false, "invalid align value: %d", align);
@@ -1620,13 +3813,14 @@ void snzu_boxAlignOuter(_snzu_Box* other, snzu_Axis ax, snzu_Align align) {
 // maintains size, only affects coords on the targeted axis
 void snzu_boxAlignInParent(snzu_Axis ax, snzu_Align align) {
     float initialSize = snzu_boxGetSizePtr(_snzu_instance->selectedBox).Elements[ax];
+    HMM_Vec2 parentStart = _snzu_boxParentStart(_snzu_instance->selectedBox);
+    HMM_Vec2 parentEnd = _snzu_boxParentEnd(_snzu_instance->selectedBox);
     if (align == SNZU_ALIGN_MIN) {
-        _snzu_instance->selectedBox->start.Elements[ax] = _snzu_instance->selectedBox->parent->start.Elements[ax];
+        _snzu_instance->selectedBox->start.Elements[ax] = parentStart.Elements[ax];
     } else if (align == SNZU_ALIGN_MAX) {
-        _snzu_instance->selectedBox->start.Elements[ax] = _snzu_instance->selectedBox->parent->end.Elements[ax] - initialSize;
+        _snzu_instance->selectedBox->start.Elements[ax] = parentEnd.Elements[ax] - initialSize;
     } else if (align == SNZU_ALIGN_CENTER) {
-        _snzu_Box* par = _snzu_instance->selectedBox->parent;
-        float midpt = (par->start.Elements[ax] + par->end.Elements[ax]) / 2.0f;
+        float midpt = (parentStart.Elements[ax] + parentEnd.Elements[ax]) / 2.0f;
         _snzu_instance->selectedBox->start.Elements[ax] = midpt - (initialSize / 2);
     } else {
         SNZ_ASSERTF(false, "invalid align value: %d", align);
@@ -1638,29 +3832,32 @@ void snzu_boxAlignInParent(snzu_Axis ax, snzu_Align align) {
 // only inserts a gap after a sibling, not if it is the first element
 // maintains size and relative positioning of all inner boxes
 void snzu_boxSetPosAfterRecurse(float gap, snzu_Axis ax) {
-    HMM_Vec2 newPos = _snzu_instance->selectedBox->parent->start;
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    HMM_Vec2 newPos = _snzu_boxParentStart(box);
 
-    if (_snzu_instance->selectedBox->prevSibling != NULL) {
-        newPos.Elements[ax] = _snzu_instance->selectedBox->prevSibling->end.Elements[ax] + gap;
-    } else {
-        newPos.Elements[ax] = _snzu_instance->selectedBox->parent->start.Elements[ax];
+    if (box->prevSibling != NULL) {
+        newPos.Elements[ax] = box->prevSibling->end.Elements[ax] + gap;
     }
-    snzu_boxSetStartKeepSizeRecurse(newPos);
+    _snzu_boxMoveRecurse(box, HMM_SubV2(newPos, box->start));
 }
 
 // recursively moves every box within the currently selected box to be ordered in a row, with the last one aligned to the bottom/end
 void snzu_boxOrderChildrenInRowRecurseAlignEnd(float gap, snzu_Axis ax) {
-    for (_snzu_Box* child = _snzu_instance->selectedBox->lastChild; child; child = child->prevSibling) {
+    _snzu_Box* parent = _snzu_instance->selectedBox;
+    // parents coords in the space of its children
+    HMM_Vec2 parentStart = HMM_SubV2(parent->start, parent->childOffset);
+    HMM_Vec2 parentEnd = HMM_SubV2(parent->end, parent->childOffset);
+    for (_snzu_Box* child = parent->lastChild; child; child = child->prevSibling) {
         float newEnd = 0;
         if (child->nextSibling) {
             newEnd = child->nextSibling->start.Elements[ax] - gap;
         } else {
-            newEnd = _snzu_instance->selectedBox->end.Elements[ax];
+            newEnd = parentEnd.Elements[ax];
         }
 
-        HMM_Vec2 start = _snzu_instance->selectedBox->start;
+        HMM_Vec2 start = parentStart;
         start.Elements[ax] = newEnd - (child->end.Elements[ax] - child->start.Elements[ax]);
-        snzu_boxSetStartKeepSizeRecursePtr(child, start);
+        _snzu_boxMoveRecurse(child, HMM_SubV2(start, child->start));
     }
 }
 
@@ -1686,8 +3883,8 @@ void snzu_boxOrderSiblingsInRowRecurse(float gap, snzu_Axis ax) {
 // padding in pixels, measures the gap between text and box on all sides, isnt scaled by boxSetDisplayStrSettings
 void snzu_boxSetSizeFitText(float padding) {
     _snzu_Box* box = _snzu_instance->selectedBox;
-    const snzr_Font* font = box->font;
-    HMM_Vec2 size = snzr_strSize(font, box->displayStr, box->displayStrLen, box->displayStrRenderedHeight);
+    SNZ_ASSERT(box->text && box->text->font, "fitting box to text, but it doesn't have a display str");
+    HMM_Vec2 size = _snzu_boxTextSize(box->text);
     size = HMM_AddV2(size, HMM_V2(padding * 2, padding * 2));
     box->end = HMM_AddV2(box->start, size);
 }
@@ -1706,7 +3903,8 @@ float snzu_boxGetMaxChildSizeAx(snzu_Axis ax) {
 // calculates size based on extent of the children relative to the parent at call time
 float snzu_boxGetSizeToFitChildrenAx(snzu_Axis ax) {
     float max = 0;
-    float parentStart = _snzu_instance->selectedBox->start.Elements[ax];
+    _snzu_Box* box = _snzu_instance->selectedBox;
+    float parentStart = box->start.Elements[ax] - box->childOffset.Elements[ax];
     for (_snzu_Box* child = _snzu_instance->selectedBox->firstChild; child; child = child->nextSibling) {
         float dist = child->start.Elements[ax] - parentStart;
         if (dist > max) {
@@ -1727,10 +3925,28 @@ void snzu_boxSetSizeFitChildren() {
     snzu_boxSetSizeFromStart(HMM_V2(x, y));
 }
 
+// set by anything that needs another frame to run soon even if no input comes in, snz_main clears it every frame
+static bool _snzu_frameRequested = false;
+
+// asks for another frame, for anything animating that doesn't go through snzu_ease*
+// without this, snz_main may sleep until the next input once nothing is moving
+void snzu_requestFrame() {
+    _snzu_frameRequested = true;
+}
+
+// eases get snapped to their target once they are this close, so that they stop asking for frames
+#define _SNZU_EASE_SETTLE_EPSILON 0.001f
+
 void snzu_easeExpUnbounded(float* in, float target, float pctPerSec) {
     float diff = target - *in;
     diff *= pctPerSec * _snzu_instance->timeSinceLastFrame;
     *in += diff;
+    if (fabsf(target - *in) < _SNZU_EASE_SETTLE_EPSILON) {
+        *in = target;
+    } else {
+        snzu_requestFrame();
+    }
+    _snzu_boxCacheMixFloat(*in);
 }
 
 // eases a float closer to target (which should be between 0 and 1) (in will be clamped to this range, should not be null)
@@ -1743,8 +3959,16 @@ void snzu_easeExp(float* in, float target, float pctPerSec) {
     } else if (*in < 0) {
         *in = 0;
     }
+    float clampedTarget = SNZ_MAX(0, SNZ_MIN(1, target));
+    if (fabsf(clampedTarget - *in) < _SNZU_EASE_SETTLE_EPSILON) {
+        *in = clampedTarget;
+    } else {
+        snzu_requestFrame();
+    }
+    _snzu_boxCacheMixFloat(*in);
 }
 
+// never settles, so it asks for a frame every time it's called. Stop calling it once the value is done
 void snzu_easeLinearUnbounded(float* in, float target, float pctPerSec) {
     float dir = 0;
     if (target > 0) {
@@ -1753,12 +3977,21 @@ void snzu_easeLinearUnbounded(float* in, float target, float pctPerSec) {
         dir = -1;
     }
     *in += pctPerSec * _snzu_instance->timeSinceLastFrame * dir;
+    snzu_requestFrame();
+    _snzu_boxCacheMixFloat(*in);
 }
 
+// moves towards 1 when target is positive and towards 0 otherwise
 void snzu_easeLinear(float* in, float target, float pctPerSec) {
+    float end = target > 0 ? 1 : 0;
+    if (*in == end) {
+        _snzu_boxCacheMixFloat(*in);
+        return;
+    }
     snzu_easeLinearUnbounded(in, target, pctPerSec);
     *in = SNZ_MIN(1, *in);
     *in = SNZ_MAX(0, *in);
+    _snzu_boxCacheMixFloat(*in);
 }
 
 void snzu_boxHighlightByAnim(float* anim, HMM_Vec4 baseColor, float diff) {
@@ -1782,6 +4015,66 @@ void snz_quit() {
     _snz_shouldQuit = true;
 }
 
+// frames keep running for this many frames after the last input, because interactions made from an input
+// only get seen by build code on the frame after it
+#define _SNZ_IDLE_SETTLE_FRAMES 2
+// waits for input wake up this often anyways, so that nothing can get stuck for long
+#define _SNZ_IDLE_WAIT_TIMEOUT_MS 500
+
+static struct {
+    bool idleWait;
+    int vsync;
+    bool vsyncDirty;
+    float fpsCap;
+} _snz_frameSettings = {
+    .idleWait = true,
+    .vsync = 1,
+    .vsyncDirty = true,
+    .fpsCap = 0,
+};
+
+// when enabled, snz_main sleeps until the next input whenever nothing is animating, see snzu_requestFrame
+// defaults to true
+void snz_setIdleWait(bool enabled) {
+    _snz_frameSettings.idleWait = enabled;
+}
+
+// 0 for off, 1 for on, -1 for adaptive (which falls back to on if the driver doesn't have it). defaults to 1
+void snz_setVsync(int interval) {
+    _snz_frameSettings.vsync = interval;
+    _snz_frameSettings.vsyncDirty = true;
+}
+
+// frames get delayed so that there are at most this many a second, 0 or less for no cap. defaults to 0
+void snz_setFpsCap(float fps) {
+    _snz_frameSettings.fpsCap = fps;
+}
+
+static void _snz_handleEvent(const SDL_Event* e, snzu_Input* uiInputs) {
+    if (e->type == SDL_QUIT) {
+        _snz_shouldQuit = true;
+    } else if (e->type == SDL_WINDOWEVENT) {
+        _snzu_damage.forceRedraw = true;  // resizes, uncovering, etc. may have trashed what's on screen
+    } else if (e->type == SDL_MOUSEWHEEL) {
+        uiInputs->mouseScrollY = e->wheel.preciseY;
+    } else if (e->type == SDL_KEYDOWN) {
+        uiInputs->keyAction = SNZU_ACT_DOWN;
+        uiInputs->keyCode = e->key.keysym.sym;
+    } else if (e->type == SDL_KEYUP) {
+        uiInputs->keyAction = SNZU_ACT_UP;
+        uiInputs->keyCode = e->key.keysym.sym;
+    } else if (e->type == SDL_TEXTINPUT) {
+        _STATIC_ASSERT(_SNZU_TEXT_INPUT_CHAR_MAX < SDL_TEXTINPUTEVENT_TEXT_SIZE);
+        for (uint64_t i = 0; i < _SNZU_TEXT_INPUT_CHAR_MAX; i++) {
+            uiInputs->charsEntered[i] = e->text.text[i];
+        }
+    } else if (e->type == SDL_MOUSEBUTTONDOWN) {
+        if (e->button.clicks == 2 && e->button.button == SDL_BUTTON_LEFT) {
+            uiInputs->doubleClick = true;
+        }
+    }
+}
+
 // icon path may be null
 void snz_main(const char* windowTitle, const char* iconPath, snz_InitFunc initFunc, snz_FrameFunc frameFunc) {
     SDL_Window* window = NULL;
@@ -1817,8 +4110,49 @@ void snz_main(const char* windowTitle, const char* iconPath, snz_InitFunc initFu
     snz_arenaClear(&frameArena);
 
     float prevTime = 0.0;
+    uint64_t settleFramesLeft = _SNZ_IDLE_SETTLE_FRAMES;
     while (!_snz_shouldQuit) {
-        float time = (float)SDL_GetTicks64() / 1000;
+        if (_snz_frameSettings.vsyncDirty) {
+            _snz_frameSettings.vsyncDirty = false;
+            if (SDL_GL_SetSwapInterval(_snz_frameSettings.vsync) != 0 && _snz_frameSettings.vsync == -1) {
+                SDL_GL_SetSwapInterval(1);
+            }
+        }
+
+        snzu_Input uiInputs = (snzu_Input){ 0 };
+        bool anyEvents = false;
+
+        SDL_Event e;
+        if (_snz_frameSettings.idleWait && settleFramesLeft == 0 && !_snzu_frameRequested) {
+            uint64_t waitStart = SDL_GetTicks64();
+            if (SDL_WaitEventTimeout(&e, _SNZ_IDLE_WAIT_TIMEOUT_MS)) {
+                _snz_handleEvent(&e, &uiInputs);
+                anyEvents = true;
+            }
+            // nothing was moving while waiting, so it shouldn't count towards dt
+            prevTime += (float)(SDL_GetTicks64() - waitStart) / 1000;
+        }
+
+#ifdef SNZ_PROFILE
+        _snz_profileFrameBegin();
+#endif
+        _SNZ_PROFILE_BEGIN(SNZ_PROFILE_PHASE_EVENTS);
+        while (SDL_PollEvent(&e)) {
+            _snz_handleEvent(&e, &uiInputs);
+            anyEvents = true;
+        }  // end event polling
+        _SNZ_PROFILE_END(SNZ_PROFILE_PHASE_EVENTS);
+
+        if (anyEvents) {
+            settleFramesLeft = _SNZ_IDLE_SETTLE_FRAMES;
+        } else if (settleFramesLeft > 0) {
+            settleFramesLeft--;
+        }
+        _snzu_frameRequested = false;
+
+        uint64_t frameStartTicks = SDL_GetTicks64();
+        uint64_t frameStartCounter = SDL_GetPerformanceCounter();  // for pacing, ms ticks are too coarse for high refresh rates
+        float time = (float)frameStartTicks / 1000;
         float dt = time - prevTime;
         prevTime = time;
         dt = SNZ_MIN(dt, 0.2);
@@ -1827,32 +4161,6 @@ void snz_main(const char* windowTitle, const char* iconPath, snz_InitFunc initFu
         SDL_GL_GetDrawableSize(window, &screenW, &screenH);
         _snzr_globs.screenSize = HMM_V2(screenW, screenH);
 
-        snzu_Input uiInputs = (snzu_Input){ 0 };
-
-        SDL_Event e;
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) {
-                _snz_shouldQuit = true;
-            } else if (e.type == SDL_MOUSEWHEEL) {
-                uiInputs.mouseScrollY = e.wheel.preciseY;
-            } else if (e.type == SDL_KEYDOWN) {
-                uiInputs.keyAction = SNZU_ACT_DOWN;
-                uiInputs.keyCode = e.key.keysym.sym;
-            } else if (e.type == SDL_KEYUP) {
-                uiInputs.keyAction = SNZU_ACT_UP;
-                uiInputs.keyCode = e.key.keysym.sym;
-            } else if (e.type == SDL_TEXTINPUT) {
-                _STATIC_ASSERT(_SNZU_TEXT_INPUT_CHAR_MAX < SDL_TEXTINPUTEVENT_TEXT_SIZE);
-                for (uint64_t i = 0; i < _SNZU_TEXT_INPUT_CHAR_MAX; i++) {
-                    uiInputs.charsEntered[i] = e.text.text[i];
-                }
-            } else if (e.type == SDL_MOUSEBUTTONDOWN) {
-                if (e.button.clicks == 2 && e.button.button == SDL_BUTTON_LEFT) {
-                    uiInputs.doubleClick = true;
-                }
-            }
-        }  // end event polling
-
         int mouseX, mouseY;
         uint32_t mouseButtons = SDL_GetMouseState(&mouseX, &mouseY);
         uiInputs.mousePos = HMM_V2(mouseX, mouseY);
@@ -1866,10 +4174,59 @@ void snz_main(const char* windowTitle, const char* iconPath, snz_InitFunc initFu
         snzr_callGLFnOrError(glClearColor(1, 1, 1, 1));
         snzr_callGLFnOrError(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
+        _SNZ_PROFILE_BEGIN(SNZ_PROFILE_PHASE_BUILD);
         frameFunc(dt, &frameArena, uiInputs, HMM_V2(screenW, screenH));
-
+        snzr_flush();
+        _SNZ_PROFILE_END(SNZ_PROFILE_PHASE_BUILD);
+
+        // when snzu skipped drawing and nothing else drew, the last frame is still good and stays up
+        bool skipSwap = _snzu_damage.instancesSkipped > 0 && _snzr_glState.frameStats.drawCalls == 0;
+        _snzu_damage.forceRedraw = false;
+        _snzu_damage.instancesDrawnLastFrame = _snzu_damage.instancesDrawn;
+        _snzu_damage.instancesDrawn = 0;
+        _snzu_damage.instancesSkipped = 0;
+
+#ifdef SNZ_PROFILE
+        _snz_profileFrameGather(&frameArena);
+#endif
+        _snzr_frameStatsRollOver();
+#ifdef SNZ_ARENA_INSTRUMENT
+        snz_arenaStatsFrameEnd(dt);
+#endif
+        _SNZ_PROFILE_BEGIN(SNZ_PROFILE_PHASE_ARENA_CLEAR);
         snz_arenaClear(&frameArena);
-        SDL_GL_SwapWindow(window);
+        _SNZ_PROFILE_END(SNZ_PROFILE_PHASE_ARENA_CLEAR);
+
+        _SNZ_PROFILE_BEGIN(SNZ_PROFILE_PHASE_SWAP);
+        if (!skipSwap) {
+            SDL_GL_SwapWindow(window);
+        }
+        _SNZ_PROFILE_END(SNZ_PROFILE_PHASE_SWAP);
+#ifdef SNZ_PROFILE
+        _snz_profileFrameEnd();
+#endif
+
+        // skipped swaps don't wait on vsync, so those get paced to the display instead
+        float fpsCap = _snz_frameSettings.fpsCap;
+        if (skipSwap && _snz_frameSettings.vsync != 0) {
+            int refreshRate = 60;
+            SDL_DisplayMode mode = { 0 };
+            if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &mode) == 0 && mode.refresh_rate > 0) {
+                refreshRate = mode.refresh_rate;
+            }
+            if (fpsCap <= 0 || fpsCap > refreshRate) {
+                fpsCap = refreshRate;
+            }
+        }
+        if (fpsCap > 0) {
+            uint64_t freq = SDL_GetPerformanceFrequency();
+            uint64_t frameEnd = frameStartCounter + (uint64_t)((double)freq / fpsCap);
+            // sleeps can run over by about a ms, so the last one gets yielded away instead
+            for (uint64_t now = SDL_GetPerformanceCounter(); now < frameEnd; now = SDL_GetPerformanceCounter()) {
+                uint64_t msLeft = (frameEnd - now) * 1000 / freq;
+                SDL_Delay(msLeft > 1 ? (uint32_t)(msLeft - 1) : 0);
+            }
+        }
     }  // end main loop
 
     snz_arenaDeinit(&frameArena);
@@ -1877,6 +4234,170 @@ void snz_main(const char* windowTitle, const char* iconPath, snz_InitFunc initFu
     // FIXME: gc gpu resources, all allocated arenas, etc.
 }
 
+#ifdef SNZ_ARENA_INSTRUMENT
+#define _SNZUC_ARENA_STATS_SITE_COUNT 16
+
+// overlay listing every tracked arena and the call sites that pushed the most last frame
+// built in the top left of the current parent, strings are formatted into scratch
+void snzuc_arenaStatsPanel(const snzr_Font* font, snz_Arena* scratch) {
+    snzu_boxNew("arenaStatsPanel");
+    snzu_boxSetStartFromParentStart(HMM_V2(10, 10));
+    snzu_boxSetColor(HMM_V4(0, 0, 0, 0.85));
+    snzu_boxSetCornerRadius(10);
+    snzu_boxSetInteractionOutput(NULL, SNZU_IF_HOVER | SNZU_IF_MOUSE_BUTTONS | SNZU_IF_MOUSE_SCROLL);
+    snzu_boxScope() {
+        snz_ArenaUsageStatsSlice arenas = snz_arenaStatsArenas();
+        for (int64_t i = 0; i < arenas.count; i++) {
+            snz_ArenaUsageStats* a = &arenas.elems[i];
+            snzu_boxNew(snz_arenaFormatStr(scratch, "arena %lld", i));
+            snzu_boxSetDisplayStr(font, HMM_V4(1, 1, 1, 1),
+                                  snz_arenaFormatStr(scratch, "%s: %lld / %lld used, peak %lld (max %lld), %lld B/frame, %.0f B/s",
+                                                     a->name, a->used, a->reserved, a->lastFramePeak, a->maxPeak, a->lastFrameBytes, a->bytesPerSec));
+            snzu_boxSetSizeFitText(2);
+        }
+
+        // selection sort for the top few, there aren't many sites and we only want a handful
+        snz_ArenaSiteStatsSlice sites = snz_arenaStatsSites();
+        bool* picked = SNZ_ARENA_PUSH_ARR(scratch, sites.count, bool);
+        for (int64_t i = 0; i < _SNZUC_ARENA_STATS_SITE_COUNT; i++) {
+            snz_ArenaSiteStats* max = NULL;
+            int64_t maxIdx = 0;
+            for (int64_t j = 0; j < sites.count; j++) {
+                if (picked[j]) {
+                    continue;
+                } else if (!max || sites.elems[j].lastFrameBytes > max->lastFrameBytes) {
+                    max = &sites.elems[j];
+                    maxIdx = j;
+                }
+            }
+            if (!max) {
+                break;
+            }
+            picked[maxIdx] = true;
+
+            snzu_boxNew(snz_arenaFormatStr(scratch, "site %lld", i));
+            snzu_boxSetDisplayStr(font, HMM_V4(0.8, 0.8, 0.8, 1),
+                                  snz_arenaFormatStr(scratch, "%s:%lld (%s): %lld B in %lld pushes last frame, %lld B total",
+                                                     max->file, max->line, arenas.elems[max->arenaIdx].name,
+                                                     max->lastFrameBytes, max->lastFrameCount, max->totalBytes));
+            snzu_boxSetSizeFitText(2);
+        }
+    }
+    snzu_boxOrderChildrenInRowRecurse(0, SNZU_AX_Y);
+    snzu_boxSetSizeFitChildren();
+}
+#endif
+
+#ifdef SNZ_PROFILE
+#define _SNZUC_PROFILE_GRAPH_FRAMES 120
+#define _SNZUC_PROFILE_GRAPH_BAR_WIDTH 3
+#define _SNZUC_PROFILE_GRAPH_HEIGHT 100
+#define _SNZUC_PROFILE_GRAPH_MS 33.3f  // frame time at the top of the graph
+
+// overlay graphing the cpu phases of the last few frames, with averages and the last frames counters under it
+// built in the top left of the current parent, strings are formatted into scratch
+void snzuc_profilePanel(const snzr_Font* font, snz_Arena* scratch) {
+    HMM_Vec4 phaseColors[SNZ_PROFILE_PHASE_COUNT] = {
+        HMM_V4(0.4, 0.6, 1.0, 1),  // events
+        HMM_V4(0.3, 0.8, 0.4, 1),  // build
+        HMM_V4(0.9, 0.8, 0.3, 1),  // layout
+        HMM_V4(1.0, 0.5, 0.2, 1),  // draw
+        HMM_V4(0.8, 0.4, 0.9, 1),  // interactions
+        HMM_V4(0.6, 0.6, 0.6, 1),  // arena clear
+        HMM_V4(0.9, 0.3, 0.3, 1),  // swap
+    };
+    float pxPerMs = _SNZUC_PROFILE_GRAPH_HEIGHT / _SNZUC_PROFILE_GRAPH_MS;
+    float graphWidth = _SNZUC_PROFILE_GRAPH_FRAMES * _SNZUC_PROFILE_GRAPH_BAR_WIDTH;
+
+    float phaseAvgs[SNZ_PROFILE_PHASE_COUNT] = { 0 };
+    float frameAvg = 0;
+    float gpuMs = -1;  // from the newest frame that has one
+    uint64_t frameCount = 0;
+    for (; frameCount < _SNZUC_PROFILE_GRAPH_FRAMES; frameCount++) {
+        const snz_ProfileFrame* frame = snz_profileGetFrame(frameCount);
+        if (!frame) {
+            break;
+        }
+        for (int i = 0; i < SNZ_PROFILE_PHASE_COUNT; i++) {
+            phaseAvgs[i] += frame->cpuMs[i];
+        }
+        frameAvg += frame->frameMs;
+        if (gpuMs < 0) {
+            gpuMs = frame->gpuMs;
+        }
+    }
+    if (frameCount > 0) {
+        for (int i = 0; i < SNZ_PROFILE_PHASE_COUNT; i++) {
+            phaseAvgs[i] /= frameCount;
+        }
+        frameAvg /= frameCount;
+    }
+
+    snzu_boxNew("profilePanel");
+    snzu_boxSetStartFromParentStart(HMM_V2(10, 10));
+    snzu_boxSetColor(HMM_V4(0, 0, 0, 0.85));
+    snzu_boxSetCornerRadius(10);
+    snzu_boxSetInteractionOutput(NULL, SNZU_IF_HOVER | SNZU_IF_MOUSE_BUTTONS | SNZU_IF_MOUSE_SCROLL);
+    snzu_boxScope() {
+        snzu_boxNew("graph");
+        snzu_boxSetSizeFromStart(HMM_V2(graphWidth, _SNZUC_PROFILE_GRAPH_HEIGHT));
+        snzu_boxClipChildren(true);
+        snzu_boxScope() {
+            // newest frame on the right, each bar stacks its phases up from the bottom
+            for (uint64_t ago = 0; ago < frameCount; ago++) {
+                const snz_ProfileFrame* frame = snz_profileGetFrame(ago);
+                snzu_boxNewU64(ago);
+                float x = (_SNZUC_PROFILE_GRAPH_FRAMES - 1 - ago) * _SNZUC_PROFILE_GRAPH_BAR_WIDTH;
+                snzu_boxSetStartFromParentStart(HMM_V2(x, 0));
+                snzu_boxSetSizeFromStart(HMM_V2(_SNZUC_PROFILE_GRAPH_BAR_WIDTH, _SNZUC_PROFILE_GRAPH_HEIGHT));
+                snzu_boxScope() {
+                    float y = _SNZUC_PROFILE_GRAPH_HEIGHT;
+                    for (int i = 0; i < SNZ_PROFILE_PHASE_COUNT; i++) {
+                        float height = frame->cpuMs[i] * pxPerMs;
+                        if (height <= 0) {
+                            continue;
+                        }
+                        y -= height;
+                        snzu_boxNewU64(i);
+                        snzu_boxSetStartFromParentStart(HMM_V2(0, y));
+                        snzu_boxSetSizeFromStart(HMM_V2(_SNZUC_PROFILE_GRAPH_BAR_WIDTH, height));
+                        snzu_boxSetColor(phaseColors[i]);
+                    }
+                }
+            }
+
+            snzu_boxNew("60fps");
+            snzu_boxSetStartFromParentStart(HMM_V2(0, _SNZUC_PROFILE_GRAPH_HEIGHT - (1000.0f / 60) * pxPerMs));
+            snzu_boxSetSizeFromStart(HMM_V2(graphWidth, 1));
+            snzu_boxSetColor(HMM_V4(1, 1, 1, 0.3));
+        }
+
+        for (int i = 0; i < SNZ_PROFILE_PHASE_COUNT; i++) {
+            snzu_boxNew(_snz_profilePhaseNames[i]);
+            snzu_boxSetDisplayStr(font, phaseColors[i], snz_arenaFormatStr(scratch, "%s: %.2f ms", _snz_profilePhaseNames[i], phaseAvgs[i]));
+            snzu_boxSetSizeFitText(2);
+        }
+
+        snzu_boxNew("frame");
+        snzu_boxSetDisplayStr(font, HMM_V4(1, 1, 1, 1), snz_arenaFormatStr(scratch, "frame: %.2f ms cpu, %.2f ms gpu", frameAvg, gpuMs));
+        snzu_boxSetSizeFitText(2);
+
+        const snz_ProfileFrame* last = snz_profileGetFrame(0);
+        if (last) {
+            snzu_boxNew("counters");
+            snzu_boxSetDisplayStr(font, HMM_V4(0.8, 0.8, 0.8, 1),
+                                  snz_arenaFormatStr(scratch, "%llu boxes, %llu draws, %llu glyphs, %llu useMems, %llu arena B",
+                                                     (unsigned long long)last->boxes, (unsigned long long)last->drawCalls,
+                                                     (unsigned long long)last->glyphs, (unsigned long long)last->useMemLookups,
+                                                     (unsigned long long)last->arenaBytes));
+            snzu_boxSetSizeFitText(2);
+        }
+    }
+    snzu_boxOrderChildrenInRowRecurse(0, SNZU_AX_Y);
+    snzu_boxSetSizeFitChildren();
+}
+#endif
+
 // UI COMPONENTS ===============================================================
 // UI COMPONENTS ===============================================================
 // UI COMPONENTS ===============================================================
@@ -1900,8 +4421,8 @@ bool snzuc_button(const snzr_Font* font, const char* title, float padding) {
     return false;
 }
 
-// FIXME: margin prop for inners
-void snzuc_scrollArea() {
+// sets up the selected box to take scrolling and returns its scroll position, clamped only at the top
+static float* _snzuc_scrollAreaBegin() {
     snzu_boxClipChildren(true);
 
     snzu_Interaction* const inter = SNZU_USE_MEM(snzu_Interaction, "inter");
@@ -1909,11 +4430,13 @@ void snzuc_scrollArea() {
 
     float* const scrollPosPx = SNZU_USE_MEM(float, "scrollPosPx");
     *scrollPosPx -= inter->mouseScrollY * 20;
+    return scrollPosPx;
+}
 
-    _snzu_Box* container = snzu_getSelectedBox();
+// builds the bar as the last child of container, dragging it and clamping updates scrollPosPx
+static void _snzuc_scrollBarBuild(_snzu_Box* container, float* scrollPosPx, float innerHeight) {
     float containerHeight = snzu_boxGetSizePtr(container).Y;
-    float innerHeight = snzu_boxGetSizeToFitChildrenAx(SNZU_AX_Y);
-
+    snzu_boxSelect(container);
     snzu_boxScope() {  // enter container
         snzu_boxNew("scrollBarContainer");
         snzu_boxFillParent();
@@ -1925,7 +4448,7 @@ void snzuc_scrollArea() {
             snzu_Interaction* const handleInter = SNZU_USE_MEM(snzu_Interaction, "handleInter");
             snzu_boxSetInteractionOutput(handleInter, SNZU_IF_MOUSE_BUTTONS | SNZU_IF_HOVER);
             if (handleInter->dragged) {
-                float nPos = handleInter->mousePosGlobal.Y - container->start.Y;
+                float nPos = handleInter->mousePosGlobal.Y - _snzu_boxAbsStart(container).Y;
                 // FIXME: this breaks with nested scroll areas because the container moves after this every frame, so the dragging looks wierd
                 nPos -= handleInter->dragBeginningLocal.Y;
                 nPos = nPos / containerHeight * innerHeight;
@@ -1944,15 +4467,104 @@ void snzuc_scrollArea() {
                 snzu_boxSetSizeFromStartAx(SNZU_AX_Y, scrollBarSize);
                 snzu_boxSetColor(HMM_V4(0.8, 0.8, 0.8, 0.2));
             }
+            _snzu_boxCacheMixFloat(*scrollPosPx);
+            _snzu_boxCacheMixFloat(innerHeight);
         }
     }  // exit container
+}
+
+// FIXME: margin prop for inners
+void snzuc_scrollArea() {
+    float* const scrollPosPx = _snzuc_scrollAreaBegin();
+    _snzu_Box* container = snzu_getSelectedBox();
+    float innerHeight = snzu_boxGetSizeToFitChildrenAx(SNZU_AX_Y);
+    _snzuc_scrollBarBuild(container, scrollPosPx, innerHeight);
 
     // FIXME: this is bad going into the guts of the lib like this
     for (_snzu_Box* child = container->firstChild; child; child = child->nextSibling) {
         if (child == container->lastChild) {  // skip the scroll bar casuse that shit should not be scrollin
             continue;
         }
-        snzu_boxSetStartKeepSizeRecursePtr(child, HMM_AddV2(child->start, HMM_V2(0, -(*scrollPosPx))));
+        _snzu_boxMoveRecurse(child, HMM_V2(0, -(*scrollPosPx)));
+    }
+
+    snzu_boxSelect(container);
+}
+
+// called with the rows box selected but not entered, already placed and sized to rowHeight
+// the row may resize itself along Y when the list is measuring rows
+typedef void (*snzuc_ScrollListRowFunc)(uint64_t rowIdx, void* userData);
+
+#define _SNZUC_SCROLL_LIST_OVERSCAN_ROWS 2
+
+// same behaviour as snzuc_scrollArea, but for rowCount rows of the same height stacked in a column
+// inside the selected box, and only the rows on screen (plus a couple on either side) get built.
+// rows are keyed on their index, and inset from the box by margin on every side
+// if rowHeight is <= 0, the height is measured from the first row built every frame and
+// used to lay things out on the next one
+void snzuc_scrollList(uint64_t rowCount, float rowHeight, float gap, float margin, snzuc_ScrollListRowFunc buildRow, void* userData) {
+    float* const scrollPosPx = _snzuc_scrollAreaBegin();
+    float* const measuredRowHeight = SNZU_USE_MEM(float, "measuredRowHeight");
+    _snzu_Box* container = snzu_getSelectedBox();
+    float containerHeight = snzu_boxGetSizePtr(container).Y;
+
+    bool measuring = rowHeight <= 0;
+    float height = measuring ? *measuredRowHeight : rowHeight;
+    float stride = height + gap;
+    float innerHeight = 2 * margin + (rowCount > 0 ? rowCount * stride - gap : 0);
+
+    // clamps the same way the scroll bar does, so rows line up with it
+    *scrollPosPx = fminf(innerHeight - containerHeight, *scrollPosPx);
+    if (*scrollPosPx < 0) {
+        *scrollPosPx = 0;
+    }
+
+    // scroll bar goes first because dragging it moves the rows this frame
+    _snzuc_scrollBarBuild(container, scrollPosPx, innerHeight);
+    _snzu_Box* bar = container->lastChild;
+    snzu_boxSelect(container);
+
+    uint64_t firstRow = 0;
+    uint64_t endRow = rowCount;
+    if (height > 0) {
+        float top = *scrollPosPx - margin;
+        int64_t first = (int64_t)floorf(top / stride) - _SNZUC_SCROLL_LIST_OVERSCAN_ROWS;
+        int64_t end = (int64_t)ceilf((top + containerHeight) / stride) + _SNZUC_SCROLL_LIST_OVERSCAN_ROWS;
+        firstRow = (uint64_t)SNZ_MAX(first, 0);
+        endRow = SNZ_MIN((uint64_t)SNZ_MAX(end, 0), rowCount);
+    } else if (rowCount > 0) {
+        endRow = 1;  // nothing measured yet, build one row to find out
+    }
+
+    snzu_boxScope() {
+        for (uint64_t i = firstRow; i < endRow; i++) {
+            snzu_boxNewU64(i);
+            snzu_boxFillParent();
+            snzu_boxSetSizeMarginFromParentAx(margin, SNZU_AX_X);
+            snzu_boxSetStartFromParentAx(margin + i * stride - *scrollPosPx, SNZU_AX_Y);
+            snzu_boxSetSizeFromStartAx(SNZU_AX_Y, height);
+            _snzu_Box* row = snzu_getSelectedBox();
+            buildRow(i, userData);
+            if (measuring && i == firstRow) {
+                *measuredRowHeight = snzu_boxGetSizePtr(row).Y;
+            }
+            snzu_boxSelect(row);
+        }
+    }
+
+    // FIXME: this is bad going into the guts of the lib like this
+    // the bar is moved back to the end so that it draws over the rows
+    if (bar != container->lastChild) {
+        if (bar->prevSibling) {
+            bar->prevSibling->nextSibling = bar->nextSibling;
+        } else {
+            container->firstChild = bar->nextSibling;
+        }
+        bar->nextSibling->prevSibling = bar->prevSibling;
+        bar->prevSibling = container->lastChild;
+        bar->nextSibling = NULL;
+        container->lastChild->nextSibling = bar;
+        container->lastChild = bar;
     }
 
     snzu_boxSelect(container);